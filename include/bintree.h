@@ -26,15 +26,127 @@ static_assert(offsetof(btnode, left) == 0);
 static_assert(offsetof(btnode, right) == 8);
 static_assert(offsetof(btnode, data) == 16);
 
+//------------------------------------------------------------------------------------------------------//
+//                          AN ARENA TO BUMP ALLOCATE TREE NODES FROM                                   //
+//------------------------------------------------------------------------------------------------------//
+
+// a malloc() per node scatters a tree across the heap and tearing it down takes a free() per node
+// an arena hands the nodes out back to back from chunks of BNARENA_CHUNK_NODES nodes, so neighbouring nodes share cache lines,
+// and gives all of them back at once. nodes removed from a tree go on a free list, threaded through their left pointers, to be
+// handed out again before the chunk is bumped
+#define BNARENA_CHUNK_NODES 1024LLU // default number of nodes per chunk
+
+// a chunk header, the nodes follow it in the same allocation
+typedef struct _bnchunk {
+        struct _bnchunk*   next;     // the chunk allocated before this one
+        unsigned long long capacity; // number of nodes that follow the header
+} bnchunk;
+
+static_assert(sizeof(bnchunk) == 16); // keeps the nodes that follow 8 byte aligned
+
+typedef struct _bnarena {
+        bnchunk*           chunks;         // the chunk nodes are currently bumped from, heads a list of all the chunks
+        btnode*            free;           // nodes given back with bnarena_free(), linked through their left pointers
+        unsigned long long used;           // number of nodes handed out from the current chunk
+        unsigned long long chunk_capacity; // number of nodes in every new chunk
+} bnarena;
+
+static_assert(sizeof(bnarena) == 32);
+static_assert(offsetof(bnarena, chunks) == 0);
+static_assert(offsetof(bnarena, free) == 8);
+static_assert(offsetof(bnarena, used) == 16);
+static_assert(offsetof(bnarena, chunk_capacity) == 24);
+
+// no memory is allocated until the first node is asked for, chunk_capacity 0 picks BNARENA_CHUNK_NODES
+static inline void bnarena_init(bnarena* const restrict arena, const unsigned long long chunk_capacity) {
+    assert(arena);
+
+    arena->chunks         = nullptr;
+    arena->free           = nullptr;
+    arena->chunk_capacity = chunk_capacity ? chunk_capacity : BNARENA_CHUNK_NODES;
+    arena->used           = arena->chunk_capacity; // so the first allocation asks for a chunk
+}
+
+[[nodiscard]] static inline btnode* bnarena_alloc(bnarena* const restrict arena) {
+    assert(arena);
+
+    btnode*  node  = arena->free;
+    bnchunk* chunk = nullptr;
+
+    if (node) { // recycle a node given back earlier
+        arena->free = node->left;
+        return node;
+    }
+
+    if (arena->used == arena->chunk_capacity) [[unlikely]] { // the current chunk is spent
+        // NOLINTNEXTLINE(bugprone-assignment-in-if-condition)
+        if (!(chunk = (bnchunk*) malloc(sizeof(bnchunk) + sizeof(btnode) * arena->chunk_capacity))) [[unlikely]] {
+            fprintf(stderr, "Error in %s at line %d:: malloc failed inside %s\n", __FILE__, __LINE__, __FUNCTION__);
+            return nullptr;
+        }
+        chunk->next     = arena->chunks;
+        chunk->capacity = arena->chunk_capacity;
+        arena->chunks   = chunk;
+        arena->used     = 0;
+    }
+
+    return (btnode*) (arena->chunks + 1) + arena->used++;
+}
+
+// gives a single node back to the arena, it will be handed out again by the next bnarena_alloc()
+static inline void bnarena_free(bnarena* const restrict arena, btnode* const restrict node) {
+    assert(arena);
+    assert(node);
+
+    node->left  = arena->free;
+    arena->free = node;
+}
+
+// takes back every node handed out so far in one go, keeping the current chunk around for the next tree
+static inline void bnarena_reset(bnarena* const restrict arena) {
+    assert(arena);
+
+    bnchunk *chunk = arena->chunks ? arena->chunks->next : nullptr, *next = nullptr; // NOLINT(readability-isolate-declaration)
+    for (; chunk; chunk = next) {
+        next = chunk->next;
+        free(chunk);
+    }
+
+    if (arena->chunks) arena->chunks->next = nullptr;
+    arena->free = nullptr;
+    arena->used = arena->chunks ? 0 : arena->chunk_capacity;
+}
+
+// frees every chunk, the arena can be reused as if just initialized
+static inline void bnarena_release(bnarena* const restrict arena) {
+    assert(arena);
+
+    bnarena_reset(arena);
+    free(arena->chunks);
+    arena->chunks = nullptr;
+    arena->used   = arena->chunk_capacity;
+}
+
 // a binary tree
 typedef struct _bintree {
         unsigned long long node_count; // number of nodes in the binary tree
         btnode*            root;       // root node of the binary tree
+        bnarena*           arena;      // where the nodes come from, malloc() and free() are used when this is nullptr
 } bntree;
 
-static_assert(sizeof(bntree) == 16);
+static_assert(sizeof(bntree) == 24);
 static_assert(offsetof(bntree, node_count) == 0);
 static_assert(offsetof(bntree, root) == 8);
+static_assert(offsetof(bntree, arena) == 16);
+
+// an arena backs one tree at a time, along with the trees merged into it, as releasing the tree takes back all of the arena's nodes
+static inline void bntree_init(bntree* const restrict tree, bnarena* const restrict arena /* can be nullptr */) {
+    assert(tree);
+
+    tree->node_count = 0;
+    tree->root       = nullptr;
+    tree->arena      = arena;
+}
 
 typedef enum _child_kind { ROOT = 0xFF << 0x01, LEFT = 0xFF << 0x02, RIGHT = 0xFF << 0x03 } child_kind; // arms of a node
 
@@ -103,7 +215,9 @@ static inline bool bntree_insert(
         }
     }
 
-    if (!(temp = (btnode*) malloc(sizeof(btnode)))) { // NOLINT(bugprone-assignment-in-if-condition) if the allocation fails
+    if (tree->arena) {
+        if (!(temp = bnarena_alloc(tree->arena))) return false; // NOLINT(bugprone-assignment-in-if-condition)
+    } else if (!(temp = (btnode*) malloc(sizeof(btnode)))) { // NOLINT(bugprone-assignment-in-if-condition) if the allocation fails
         fprintf(stderr, "Error in %s at line %d:: malloc failed inside %s\n", __FILE__, __LINE__, __FUNCTION__);
         return false;
     }
@@ -116,12 +230,34 @@ static inline bool bntree_insert(
     return true;
 }
 
-// remove the child of the specified parent node from the given binary tree
-static inline bool  bntree_remove( // NOLINT(misc-no-recursion)
-     bntree* const restrict tree,
-     btnode* const restrict parent,
-     const child_kind which
-) {
+// frees every node of the subtree under node without recursion or a stack, by rotating the subtree right until its top node has
+// no left child, that node can then go and its right child becomes the new top, every rotation moves a node onto the rightmost
+// path for good, so it all takes O(n) steps however deep the subtree is. returns the number of nodes freed
+static inline unsigned long long bntree_destroy_subtree(bntree* const restrict tree, btnode* restrict node) {
+    btnode*            _next  = nullptr;
+    unsigned long long _count = 0;
+
+    while (node) {
+        if (node->left) { // rotate right, the left child moves up
+            _next        = node->left;
+            node->left   = _next->right;
+            _next->right = node;
+        } else {
+            _next = node->right;
+            if (tree->arena)
+                bnarena_free(tree->arena, node);
+            else
+                free(node);
+            _count++;
+        }
+        node = _next;
+    }
+
+    return _count;
+}
+
+// remove the child of the specified parent node from the given binary tree, along with all of its descendants
+static inline bool bntree_remove(bntree* const restrict tree, btnode* const restrict parent, const child_kind which) {
     assert(tree);
     // parent can be nullptr
 
@@ -142,16 +278,10 @@ static inline bool  bntree_remove( // NOLINT(misc-no-recursion)
         }
     }
 
-    if (*target) { // if the chosen target node is not already nullptr, remove its children before removing it
-
-        bntree_remove(tree, *target, LEFT);
-        bntree_remove(tree, *target, RIGHT);
-
-        free(*target);
-        *target = nullptr;
-        tree->node_count--; // account for the node removal
-        // we don't have to account for the nodes that may have been removed by the recursive calls to bntree_remove() here
-        // because those calls themselves would have registered those removals by decrementing the node count
+    if (*target) { // if the chosen target node is not already nullptr, unhook it and free it along with its descendants
+        btnode* const _subtree  = *target;
+        *target                 = nullptr;
+        tree->node_count       -= bntree_destroy_subtree(tree, _subtree); // account for the node removals
     }
 
     return true;
@@ -167,14 +297,16 @@ static inline bntree bntree_merge(
     assert(right);
     assert(data);
 
-    bntree merged = { 0, nullptr };
+    assert(left->arena == right->arena); // the merged tree's nodes must all come from the same place
+
+    bntree merged = { 0, nullptr, left->arena };
     if (!bntree_insert(
             &merged,
             nullptr,
             ROOT, // this is just a placeholder here because since the parent is nullptr our target becomes the root node, the control flow won't even reach the switch block
             data
         )) { // if the insertion failed
-        fprintf(stderr, "Error:: ", );
+        fprintf(stderr, "Error in %s at line %d:: %s could not make a root node for the merged tree\n", __FILE__, __LINE__, __FUNCTION__);
         return merged;
     }
 
@@ -191,3 +323,216 @@ static inline bntree bntree_merge(
 
     return merged;
 }
+
+//------------------------------------------------------------------------------------------------------//
+//                      ITERATIVE TRAVERSALS WITH CALLER PROVIDED STACKS                                //
+//------------------------------------------------------------------------------------------------------//
+
+// the traversals keep the nodes they have yet to come back to in the caller's buffer instead of on the call stack, so they are
+// allocation free and their memory use is bounded by the buffer, a depth first traversal needs as many entries as the tree is
+// deep (plus one for the pre-order), the level order one as many as the widest level. node_count entries always suffice
+// the functions return false when the buffer runs out, having visited only part of the tree
+
+typedef void (*bntree_visitor)(btnode* const node, void* const context);
+
+static inline bool bntree_preorder(
+    const bntree* const restrict tree,
+    btnode** const restrict stack,
+    const unsigned long long capacity, // number of entries in stack
+    const bntree_visitor visit,
+    void* const context // passed on to visit, can be nullptr
+) {
+    assert(tree);
+    assert(stack || !capacity);
+    assert(visit);
+
+    unsigned long long _top  = 0;
+    btnode*            _node = nullptr;
+
+    if (!tree->root) return true;
+    if (!capacity) goto OVERFLOW;
+    stack[_top++] = tree->root;
+
+    while (_top) {
+        _node = stack[--_top];
+        (*visit)(_node, context);
+        // the right child goes first so the left one comes off the stack first
+        if (_node->right) {
+            if (_top == capacity) [[unlikely]] goto OVERFLOW;
+            stack[_top++] = _node->right;
+        }
+        if (_node->left) {
+            if (_top == capacity) [[unlikely]] goto OVERFLOW;
+            stack[_top++] = _node->left;
+        }
+    }
+    return true;
+
+OVERFLOW:
+    fprintf(stderr, "Error in %s at line %d:: %s ran out of stack space, %llu entries\n", __FILE__, __LINE__, __FUNCTION__, capacity);
+    return false;
+}
+
+static inline bool bntree_inorder(
+    const bntree* const restrict tree,
+    btnode** const restrict stack,
+    const unsigned long long capacity,
+    const bntree_visitor visit,
+    void* const context
+) {
+    assert(tree);
+    assert(stack || !capacity);
+    assert(visit);
+
+    unsigned long long _top  = 0;
+    btnode*            _node = tree->root;
+
+    while (_node || _top) {
+        while (_node) { // stack up the path down the left arms
+            if (_top == capacity) [[unlikely]] {
+                fprintf(
+                    stderr, "Error in %s at line %d:: %s ran out of stack space, %llu entries\n", __FILE__, __LINE__, __FUNCTION__, capacity
+                );
+                return false;
+            }
+            stack[_top++] = _node;
+            _node         = _node->left;
+        }
+
+        _node = stack[--_top];
+        (*visit)(_node, context);
+        _node = _node->right;
+    }
+    return true;
+}
+
+// the visitor may free() the node it is given, the traversal is done with a node by the time it gets visited
+static inline bool bntree_postorder(
+    const bntree* const restrict tree,
+    btnode** const restrict stack,
+    const unsigned long long capacity,
+    const bntree_visitor visit,
+    void* const context
+) {
+    assert(tree);
+    assert(stack || !capacity);
+    assert(visit);
+
+    unsigned long long _top  = 0;
+    btnode *           _node = tree->root, *_last = nullptr, *_peek = nullptr; // NOLINT(readability-isolate-declaration)
+
+    while (_node || _top) {
+        if (_node) { // stack up the path down the left arms
+            if (_top == capacity) [[unlikely]] {
+                fprintf(
+                    stderr, "Error in %s at line %d:: %s ran out of stack space, %llu entries\n", __FILE__, __LINE__, __FUNCTION__, capacity
+                );
+                return false;
+            }
+            stack[_top++] = _node;
+            _node         = _node->left;
+            continue;
+        }
+
+        _peek = stack[_top - 1];
+        if (_peek->right && _peek->right != _last) { // the right subtree has not been visited yet
+            _node = _peek->right;
+        } else {
+            _top--;
+            _last = _peek; // only ever compared against, so freeing it in the visitor is fine
+            (*visit)(_peek, context);
+        }
+    }
+    return true;
+}
+
+// visits the nodes level by level, left to right, queue is used as a ring buffer
+static inline bool bntree_levelorder(
+    const bntree* const restrict tree,
+    btnode** const restrict queue,
+    const unsigned long long capacity,
+    const bntree_visitor visit,
+    void* const context
+) {
+    assert(tree);
+    assert(queue || !capacity);
+    assert(visit);
+
+    unsigned long long _head = 0, _tail = 0, _count = 0; // NOLINT(readability-isolate-declaration)
+    btnode*            _node = nullptr;
+    btnode*            _children[2];
+
+    if (!tree->root) return true;
+    if (!capacity) goto OVERFLOW;
+    queue[_tail] = tree->root;
+    _tail        = _tail + 1 == capacity ? 0 : _tail + 1;
+    _count++;
+
+    while (_count) {
+        _node = queue[_head];
+        _head = _head + 1 == capacity ? 0 : _head + 1;
+        _count--;
+        (*visit)(_node, context);
+
+        _children[0] = _node->left;
+        _children[1] = _node->right;
+        for (unsigned i = 0; i < 2; ++i) {
+            if (!_children[i]) continue;
+            if (_count == capacity) [[unlikely]] goto OVERFLOW;
+            queue[_tail] = _children[i];
+            _tail        = _tail + 1 == capacity ? 0 : _tail + 1;
+            _count++;
+        }
+    }
+    return true;
+
+OVERFLOW:
+    fprintf(stderr, "Error in %s at line %d:: %s ran out of queue space, %llu entries\n", __FILE__, __LINE__, __FUNCTION__, capacity);
+    return false;
+}
+
+// removes every node of the tree, keeping the nodes yet to be freed in the caller's buffer, a subtree that does not fit is freed on the
+// spot by bntree_destroy_subtree(), whose rotations cost more than a stack when the tree is bushy, so any size of buffer will do
+static inline void bntree_teardown(bntree* const restrict tree, btnode** const restrict stack, const unsigned long long capacity) {
+    assert(tree);
+    assert(stack || !capacity);
+
+    unsigned long long _top = 0;
+    btnode*            _node = nullptr;
+    btnode*            _children[2];
+
+    if (tree->arena) {
+        bnarena_reset(tree->arena);
+    } else if (tree->root) {
+        if (capacity)
+            stack[_top++] = tree->root;
+        else
+            bntree_destroy_subtree(tree, tree->root);
+
+        while (_top) {
+            _node        = stack[--_top];
+            _children[0] = _node->left;
+            _children[1] = _node->right;
+            free(_node);
+
+            for (unsigned i = 0; i < 2; ++i) {
+                if (!_children[i]) continue;
+                if (_top < capacity) [[likely]]
+                    stack[_top++] = _children[i];
+                else
+                    bntree_destroy_subtree(tree, _children[i]);
+            }
+        }
+    }
+
+    tree->root       = nullptr;
+    tree->node_count = 0;
+}
+
+#define BNTREE_RELEASE_STACK 64LLU // stack entries bntree_release() keeps on the call stack, a balanced tree this deep has 2^64 nodes
+
+// removes every node of the tree, with an arena that is a single bnarena_reset() instead of a walk over the tree
+static inline void bntree_release(bntree* const restrict tree) {
+    btnode* _stack[BNTREE_RELEASE_STACK];
+    bntree_teardown(tree, _stack, BNTREE_RELEASE_STACK);
+}
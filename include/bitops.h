@@ -4,6 +4,10 @@
 #include <utilities.h>
 // clang-format on
 
+#if defined(__AVX2__) || defined(__AVX512F__)
+    #include <immintrin.h>
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //                                                      CAUTION                                                      //
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -53,3 +57,449 @@ static inline void __attribute__((__always_inline__)) xorbit( // the result will
     assert(outbuff);
     getbit(inbuff_a, offset) == getbit(inbuff_b, offset) ? setbit(outbuff, offset, false) : setbit(outbuff, offset, true);
 }
+
+//-------------------------------------------------------------------------------------------------------------------------------//
+//                                                  WORD AT A TIME BIT I/O                                                       //
+//-------------------------------------------------------------------------------------------------------------------------------//
+
+// getbit() and setbit() pay a division, a modulo and a byte sized read (modify write) for every bit, bitwriter_t and bitreader_t
+// move the bits through a 64 bit register instead and only touch the buffer with whole 8 byte loads and stores
+// both keep the bit order documented above, the first bit of the stream is the MSB of the register
+
+// most bits a single put_bits() or peek_bits() can move, with the up to 7 leftover bits of the last byte the register never fills up
+// completely, which keeps every shift below 64
+#define BITIO_MAX_BITS (56LLU)
+
+// writes the word to the buffer in big endian order so the bits land in the stream MSB first
+static inline void __attribute__((__always_inline__)) store_bigendian(unsigned char* const restrict buffer, const unsigned long long word) {
+    const unsigned long long swapped = __builtin_bswap64(word);
+    memcpy(buffer, &swapped, sizeof(unsigned long long)); // compiles down to a single unaligned store
+}
+
+// reads 8 bytes in big endian order, so the first bit of the stream lands in the MSB
+[[nodiscard]] static inline unsigned long long __attribute__((__always_inline__)) load_bigendian(const unsigned char* const restrict buffer) {
+    unsigned long long word = 0;
+    memcpy(&word, buffer, sizeof(unsigned long long));
+    return __builtin_bswap64(word);
+}
+
+typedef struct _bitwriter {
+        unsigned char*     begin;       // first byte of the bitstream
+        unsigned char*     caret;       // where the next flush goes
+        unsigned long long accumulator; // pending bits, left aligned
+        unsigned           nbits;       // number of pending bits in the accumulator, always < 8 after a flush
+} bitwriter_t;
+
+static_assert(sizeof(bitwriter_t) == 32);
+static_assert(offsetof(bitwriter_t, begin) == 0);
+static_assert(offsetof(bitwriter_t, caret) == 8);
+static_assert(offsetof(bitwriter_t, accumulator) == 16);
+static_assert(offsetof(bitwriter_t, nbits) == 24);
+
+// every flush stores all 8 bytes of the accumulator, so the buffer needs 8 bytes of slack past the last byte of the bitstream
+static inline void __attribute__((__always_inline__)) bitwriter_init(
+    bitwriter_t* const restrict writer, unsigned char* const restrict buffer
+) {
+    assert(writer);
+    assert(buffer);
+    writer->begin       = buffer;
+    writer->caret       = buffer;
+    writer->accumulator = 0;
+    writer->nbits       = 0;
+}
+
+// appends the low nbits bits of value to the accumulator without flushing, callers batching several codes between flushes must
+// keep the pending bits below 64, e.g. 4 codes of up to 14 bits each after a flush
+static inline void __attribute__((__always_inline__)) append_bits(
+    bitwriter_t* const restrict writer, const unsigned nbits /* 1 to 63 - writer->nbits */, const unsigned long long value
+) {
+    assert(writer);
+    assert(nbits && writer->nbits + nbits < 64);
+    assert(!(value >> nbits)); // no stray bits above the ones being written
+    writer->accumulator |= value << (64 - writer->nbits - nbits);
+    writer->nbits       += nbits;
+}
+
+// stores all the complete bytes in the accumulator with one unaligned store, no branch on how many there are
+static inline void __attribute__((__always_inline__)) bitwriter_flush(bitwriter_t* const restrict writer) {
+    assert(writer);
+    store_bigendian(writer->caret, writer->accumulator);
+    writer->caret        += writer->nbits / 8;
+    writer->accumulator <<= writer->nbits & ~7U;
+    writer->nbits        &= 7U;
+}
+
+// writes the low nbits bits of value to the bitstream
+static inline void __attribute__((__always_inline__)) put_bits(
+    bitwriter_t* const restrict writer, const unsigned nbits /* 1 to BITIO_MAX_BITS */, const unsigned long long value
+) {
+    assert(nbits <= BITIO_MAX_BITS);
+    append_bits(writer, nbits, value);
+    bitwriter_flush(writer);
+}
+
+// flushes the trailing partial byte, padded with 0 bits, returns the number of bytes in the bitstream
+static inline unsigned long long bitwriter_finish(bitwriter_t* const restrict writer) {
+    assert(writer);
+    store_bigendian(writer->caret, writer->accumulator);
+    writer->caret       += (writer->nbits + 7) / 8;
+    writer->accumulator  = 0;
+    writer->nbits        = 0;
+    return writer->caret - writer->begin;
+}
+
+typedef struct _bitreader {
+        const unsigned char* bitstream; // first byte of the bitstream
+        unsigned long long   nbytes;    // number of bytes in the bitstream
+        unsigned long long   bitpos;    // number of bits consumed so far
+        unsigned long long   window;    // the bits starting at bitpos, left aligned, at least 57 of them are valid after a refill
+} bitreader_t;
+
+static_assert(sizeof(bitreader_t) == 32);
+static_assert(offsetof(bitreader_t, bitstream) == 0);
+static_assert(offsetof(bitreader_t, nbytes) == 8);
+static_assert(offsetof(bitreader_t, bitpos) == 16);
+static_assert(offsetof(bitreader_t, window) == 24);
+
+// are there 8 bytes left to read at the reader's position, i.e. can bitreader_refill_fast() be used
+[[nodiscard]] static inline bool __attribute__((__always_inline__)) bitreader_has_word(const bitreader_t* const restrict reader) {
+    assert(reader);
+    return (reader->bitpos / 8) + sizeof(unsigned long long) <= reader->nbytes;
+}
+
+// refills the window with one unaligned load, the caller must make sure bitreader_has_word() holds
+static inline void __attribute__((__always_inline__)) bitreader_refill_fast(bitreader_t* const restrict reader) {
+    assert(bitreader_has_word(reader));
+    reader->window = load_bigendian(reader->bitstream + reader->bitpos / 8) << (reader->bitpos % 8);
+}
+
+// refills the window, within the last 8 bytes of the bitstream the missing bytes read as 0 bits
+static inline void __attribute__((__always_inline__)) bitreader_refill(bitreader_t* const restrict reader) {
+    assert(reader);
+    if (bitreader_has_word(reader)) [[likely]] {
+        bitreader_refill_fast(reader);
+        return;
+    }
+
+    unsigned char tail[sizeof(unsigned long long)] = { 0 }; // the last few bytes of the bitstream, padded with 0 bits
+    if (reader->bitpos / 8 < reader->nbytes) memcpy(tail, reader->bitstream + reader->bitpos / 8, reader->nbytes - reader->bitpos / 8);
+    reader->window = load_bigendian(tail) << (reader->bitpos % 8);
+}
+
+static inline void __attribute__((__always_inline__)) bitreader_init(
+    bitreader_t* const restrict reader, const unsigned char* const restrict bitstream, const unsigned long long nbytes
+) {
+    assert(reader);
+    assert(bitstream || !nbytes);
+    reader->bitstream = bitstream;
+    reader->nbytes    = nbytes;
+    reader->bitpos    = 0;
+    reader->window    = 0;
+    bitreader_refill(reader);
+}
+
+// returns the next nbits bits of the bitstream without consuming them
+[[nodiscard]] static inline unsigned long long __attribute__((__always_inline__)) peek_bits(
+    const bitreader_t* const restrict reader, const unsigned nbits /* 1 to BITIO_MAX_BITS */
+) {
+    assert(reader);
+    assert(nbits && nbits <= BITIO_MAX_BITS);
+    return reader->window >> (64 - nbits);
+}
+
+// drops the next nbits bits, no more than BITIO_MAX_BITS bits may be consumed between two refills
+static inline void __attribute__((__always_inline__)) consume_bits(bitreader_t* const restrict reader, const unsigned nbits) {
+    assert(reader);
+    assert(nbits <= BITIO_MAX_BITS);
+    reader->window <<= nbits;
+    reader->bitpos  += nbits;
+}
+
+// has the reader consumed more bits than the bitstream has
+[[nodiscard]] static inline bool __attribute__((__always_inline__)) bitreader_is_overrun(const bitreader_t* const restrict reader) {
+    assert(reader);
+    return reader->bitpos > reader->nbytes * 8;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------//
+//                                                  RANGE OPERATIONS                                                             //
+//-------------------------------------------------------------------------------------------------------------------------------//
+
+// xorbit() pays two getbit()s and a setbit() per bit, the routines below work on a range of bits at once, only the partial bytes at
+// either end of the range need masking, the whole bytes in between go through the widest vectors the target has
+// with AVX-512 the bytes that do not fill a whole vector are handled with masked loads and stores, otherwise 8 bytes at a time
+
+typedef enum _bitwise_op { BITWISE_XOR = 0x00, BITWISE_AND = 0x01 } bitwise_op;
+
+// mask of the bits first to last (0 to 7, inclusive) of a byte, in the bit order of the CAUTION block
+[[nodiscard]] static inline unsigned char __attribute__((__always_inline__)) bytemask(const unsigned first, const unsigned last) {
+    assert(first <= last && last < 8);
+    return (unsigned char) ((0xFFU >> first) & (0xFFU << (7 - last)));
+}
+
+// overwrites the bits of the byte that are set in mask with the same bits of value, leaves the rest alone
+static inline void __attribute__((__always_inline__)) maskedstore(
+    unsigned char* const restrict byte, const unsigned char value, const unsigned char mask
+) {
+    assert(byte);
+    *byte = (unsigned char) ((*byte & ~mask) | (value & mask));
+}
+
+// the nbits (1 to 8) bits of the bitstream starting at offset, left aligned in a byte with the bits below them cleared
+// the byte after the one offset points into is only read when the bits spill over into it
+[[nodiscard]] static inline unsigned char __attribute__((__always_inline__)) peekbyte(
+    const unsigned char* const restrict bitstream, const unsigned long long offset, const unsigned nbits
+) {
+    assert(bitstream);
+    assert(nbits && nbits <= 8);
+    unsigned value = (unsigned) bitstream[offset / 8] << (offset % 8);
+    if (offset % 8 + nbits > 8) value |= bitstream[offset / 8 + 1] >> (8 - offset % 8);
+    return (unsigned char) (value & (0xFF00U >> nbits));
+}
+
+[[nodiscard]] static inline unsigned char __attribute__((__always_inline__)) bitwise_apply(
+    const unsigned char byte_a, const unsigned char byte_b, const bitwise_op op
+) {
+    return (unsigned char) (op == BITWISE_XOR ? byte_a ^ byte_b : byte_a & byte_b);
+}
+
+// applies op to nbytes whole bytes, op is a compile time constant at every call site so the switches fold away
+static inline void __attribute__((__always_inline__)) bitwise_bytes(
+    const unsigned char* const restrict inbuff_a,
+    const unsigned char* const restrict inbuff_b,
+    unsigned char* const restrict outbuff,
+    const unsigned long long nbytes,
+    const bitwise_op op
+) {
+    unsigned long long i = 0;
+    unsigned long long word_a = 0, word_b = 0; // NOLINT(readability-isolate-declaration)
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+    for (; i + 64 <= nbytes; i += 64) {
+        const __m512i vec_a = _mm512_loadu_si512(inbuff_a + i), vec_b = _mm512_loadu_si512(inbuff_b + i);
+        _mm512_storeu_si512(outbuff + i, op == BITWISE_XOR ? _mm512_xor_si512(vec_a, vec_b) : _mm512_and_si512(vec_a, vec_b));
+    }
+    if (i < nbytes) { // the last few bytes, the masked lanes are neither read nor written
+        const __mmask64 mask  = ~0LLU >> (64 - (nbytes - i));
+        const __m512i   vec_a = _mm512_maskz_loadu_epi8(mask, inbuff_a + i), vec_b = _mm512_maskz_loadu_epi8(mask, inbuff_b + i);
+        _mm512_mask_storeu_epi8(outbuff + i, mask, op == BITWISE_XOR ? _mm512_xor_si512(vec_a, vec_b) : _mm512_and_si512(vec_a, vec_b));
+    }
+    return;
+#elif defined(__AVX2__)
+    for (; i + 32 <= nbytes; i += 32) {
+        const __m256i vec_a = _mm256_loadu_si256((const __m256i*) (inbuff_a + i));
+        const __m256i vec_b = _mm256_loadu_si256((const __m256i*) (inbuff_b + i));
+        _mm256_storeu_si256((__m256i*) (outbuff + i), op == BITWISE_XOR ? _mm256_xor_si256(vec_a, vec_b) : _mm256_and_si256(vec_a, vec_b));
+    }
+#endif
+
+    for (; i + sizeof(unsigned long long) <= nbytes; i += sizeof(unsigned long long)) {
+        memcpy(&word_a, inbuff_a + i, sizeof(unsigned long long));
+        memcpy(&word_b, inbuff_b + i, sizeof(unsigned long long));
+        word_a = op == BITWISE_XOR ? word_a ^ word_b : word_a & word_b;
+        memcpy(outbuff + i, &word_a, sizeof(unsigned long long));
+    }
+    for (; i < nbytes; ++i) outbuff[i] = bitwise_apply(inbuff_a[i], inbuff_b[i], op);
+}
+
+// applies op to the bits [offset, offset + count) of the two buffers and stores the results at the same bits of the output buffer
+static inline void __attribute__((__always_inline__)) bitwise_range(
+    const unsigned char* const restrict inbuff_a,
+    const unsigned char* const restrict inbuff_b,
+    unsigned char* const restrict outbuff,
+    const unsigned long long offset,
+    const unsigned long long count,
+    const bitwise_op op
+) {
+    assert(inbuff_a);
+    assert(inbuff_b);
+    assert(outbuff);
+    if (!count) return;
+
+    unsigned long long       first = offset / 8; // the byte with the first bit of the range
+    const unsigned long long last  = (offset + count - 1) / 8;
+    const unsigned char      head  = bytemask(offset % 8, 7); // the bits of the first byte inside the range
+    const unsigned char      tail  = bytemask(0, (offset + count - 1) % 8);
+
+    if (first == last) { // the whole range is inside a single byte
+        maskedstore(outbuff + first, bitwise_apply(inbuff_a[first], inbuff_b[first], op), head & tail);
+        return;
+    }
+
+    if (head != 0xFF) {
+        maskedstore(outbuff + first, bitwise_apply(inbuff_a[first], inbuff_b[first], op), head);
+        first++;
+    }
+    if (tail != 0xFF) maskedstore(outbuff + last, bitwise_apply(inbuff_a[last], inbuff_b[last], op), tail);
+
+    bitwise_bytes(inbuff_a + first, inbuff_b + first, outbuff + first, last - first + (tail == 0xFF), op);
+}
+
+// computes the bitwise xor of the bits [offset, offset + count) of the passed buffers, and stores the result at the same bits of
+// the output buffer, the bits of the output buffer outside the range are left alone
+static inline void xorbits(
+    const unsigned char* const restrict inbuff_a,
+    const unsigned char* const restrict inbuff_b,
+    unsigned char* const restrict outbuff,
+    const unsigned long long offset,
+    const unsigned long long count
+) {
+    bitwise_range(inbuff_a, inbuff_b, outbuff, offset, count, BITWISE_XOR);
+}
+
+// computes the bitwise and of the bits [offset, offset + count) of the passed buffers, and stores the result at the same bits of
+// the output buffer, the bits of the output buffer outside the range are left alone
+static inline void andbits(
+    const unsigned char* const restrict inbuff_a,
+    const unsigned char* const restrict inbuff_b,
+    unsigned char* const restrict outbuff,
+    const unsigned long long offset,
+    const unsigned long long count
+) {
+    bitwise_range(inbuff_a, inbuff_b, outbuff, offset, count, BITWISE_AND);
+}
+
+// copies nbytes whole bytes of bits that begin shift (0 to 7) bits into inbuff, output byte i is made of the low 8 - shift bits of
+// input byte i and the high shift bits of input byte i + 1, which is only read when shift is non zero
+static inline void __attribute__((__always_inline__)) copy_shifted_bytes(
+    const unsigned char* const restrict inbuff, unsigned char* const restrict outbuff, const unsigned long long nbytes, const unsigned shift
+) {
+    assert(shift < 8);
+    if (!shift) {
+        memcpy(outbuff, inbuff, nbytes);
+        return;
+    }
+
+    unsigned long long i = 0;
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+    // there are no byte wide shifts, so shift the 16 bit lanes and mask off the bits that crossed over from the neighbouring byte
+    const __m128i lcount = _mm_cvtsi32_si128((int) shift), rcount = _mm_cvtsi32_si128((int) (8 - shift));
+#endif
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+    const __m512i lmask = _mm512_set1_epi8((char) (0xFFU << shift)), rmask = _mm512_set1_epi8((char) (0xFFU >> (8 - shift)));
+    for (; i + 64 <= nbytes; i += 64) {
+        const __m512i high = _mm512_loadu_si512(inbuff + i), low = _mm512_loadu_si512(inbuff + i + 1);
+        _mm512_storeu_si512(
+            outbuff + i,
+            _mm512_or_si512(_mm512_and_si512(_mm512_sll_epi16(high, lcount), lmask), _mm512_and_si512(_mm512_srl_epi16(low, rcount), rmask))
+        );
+    }
+    if (i < nbytes) {
+        const __mmask64 mask = ~0LLU >> (64 - (nbytes - i));
+        const __m512i   high = _mm512_maskz_loadu_epi8(mask, inbuff + i), low = _mm512_maskz_loadu_epi8(mask, inbuff + i + 1);
+        _mm512_mask_storeu_epi8(
+            outbuff + i,
+            mask,
+            _mm512_or_si512(_mm512_and_si512(_mm512_sll_epi16(high, lcount), lmask), _mm512_and_si512(_mm512_srl_epi16(low, rcount), rmask))
+        );
+    }
+    return;
+#elif defined(__AVX2__)
+    const __m256i lmask = _mm256_set1_epi8((char) (0xFFU << shift)), rmask = _mm256_set1_epi8((char) (0xFFU >> (8 - shift)));
+    for (; i + 32 <= nbytes; i += 32) {
+        const __m256i high = _mm256_loadu_si256((const __m256i*) (inbuff + i)), low = _mm256_loadu_si256((const __m256i*) (inbuff + i + 1));
+        _mm256_storeu_si256(
+            (__m256i*) (outbuff + i),
+            _mm256_or_si256(_mm256_and_si256(_mm256_sll_epi16(high, lcount), lmask), _mm256_and_si256(_mm256_srl_epi16(low, rcount), rmask))
+        );
+    }
+#endif
+
+    for (; i + sizeof(unsigned long long) <= nbytes; i += sizeof(unsigned long long))
+        store_bigendian(outbuff + i, (load_bigendian(inbuff + i) << shift) | (inbuff[i + 8] >> (8 - shift)));
+    for (; i < nbytes; ++i) outbuff[i] = (unsigned char) ((inbuff[i] << shift) | (inbuff[i + 1] >> (8 - shift)));
+}
+
+// copies count bits starting at bit inoffset of inbuff to the bits starting at bit outoffset of outbuff, the two offsets need not
+// share their alignment within a byte, the bits of outbuff outside the range are left alone, the buffers must not overlap
+static inline void copybits(
+    const unsigned char* const restrict inbuff,
+    unsigned long long inoffset,
+    unsigned char* const restrict outbuff,
+    unsigned long long outoffset,
+    unsigned long long count
+) {
+    assert(inbuff);
+    assert(outbuff);
+    if (!count) return;
+
+    if (outoffset % 8) { // fill up the output byte the range begins in
+        const unsigned nbits = count < 8 - outoffset % 8 ? (unsigned) count : (unsigned) (8 - outoffset % 8);
+        maskedstore(
+            outbuff + outoffset / 8,
+            (unsigned char) (peekbyte(inbuff, inoffset, nbits) >> (outoffset % 8)),
+            bytemask(outoffset % 8, outoffset % 8 + nbits - 1)
+        );
+        inoffset  += nbits;
+        outoffset += nbits;
+        count     -= nbits;
+    }
+
+    copy_shifted_bytes(inbuff + inoffset / 8, outbuff + outoffset / 8, count / 8, inoffset % 8);
+    inoffset  += count & ~7LLU;
+    outoffset += count & ~7LLU;
+
+    if (count % 8) maskedstore(outbuff + outoffset / 8, peekbyte(inbuff, inoffset, count % 8), bytemask(0, count % 8 - 1));
+}
+
+// number of set bits in nbytes whole bytes
+[[nodiscard]] static inline unsigned long long __attribute__((__always_inline__)) popcount_bytes(
+    const unsigned char* const restrict bitstream, const unsigned long long nbytes
+) {
+    unsigned long long i = 0, count = 0, word = 0; // NOLINT(readability-isolate-declaration)
+
+#if defined(__AVX512F__) && defined(__AVX512BW__) && defined(__AVX512VPOPCNTDQ__)
+    __m512i counts = _mm512_setzero_si512();
+    for (; i + 64 <= nbytes; i += 64) counts = _mm512_add_epi64(counts, _mm512_popcnt_epi64(_mm512_loadu_si512(bitstream + i)));
+    if (i < nbytes) {
+        counts = _mm512_add_epi64(counts, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi8(~0LLU >> (64 - (nbytes - i)), bitstream + i)));
+        i      = nbytes;
+    }
+    unsigned long long lanes[8] = { 0 }; // _mm512_reduce_add_epi64() trips a -Wmaybe-uninitialized inside GCC 12's own headers
+    _mm512_storeu_si512(lanes, counts);
+    for (unsigned k = 0; k < 8; ++k) count += lanes[k];
+#elif defined(__AVX2__)
+    // looks up the counts of both nibbles of every byte with a shuffle, then sums the bytes of every 8 byte lane with a sad
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    __m256i       counts = _mm256_setzero_si256();
+    for (; i + 32 <= nbytes; i += 32) {
+        const __m256i vec  = _mm256_loadu_si256((const __m256i*) (bitstream + i));
+        const __m256i sums = _mm256_add_epi8(
+            _mm256_shuffle_epi8(lookup, _mm256_and_si256(vec, nibble)),
+            _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(vec, 4), nibble))
+        );
+        counts = _mm256_add_epi64(counts, _mm256_sad_epu8(sums, _mm256_setzero_si256()));
+    }
+    count = (unsigned long long) (_mm256_extract_epi64(counts, 0) + _mm256_extract_epi64(counts, 1) + _mm256_extract_epi64(counts, 2) +
+                                  _mm256_extract_epi64(counts, 3));
+#endif
+
+    for (; i + sizeof(unsigned long long) <= nbytes; i += sizeof(unsigned long long)) {
+        memcpy(&word, bitstream + i, sizeof(unsigned long long));
+        count += (unsigned long long) __builtin_popcountll(word);
+    }
+    for (; i < nbytes; ++i) count += (unsigned long long) __builtin_popcount(bitstream[i]);
+    return count;
+}
+
+// number of set bits in the bits [offset, offset + count) of the bitstream
+[[nodiscard]] static inline unsigned long long popcount_range(
+    const unsigned char* const restrict bitstream, const unsigned long long offset, const unsigned long long count
+) {
+    assert(bitstream);
+    if (!count) return 0;
+
+    unsigned long long       first = offset / 8;
+    const unsigned long long last  = (offset + count - 1) / 8;
+    const unsigned char      head  = bytemask(offset % 8, 7);
+    const unsigned char      tail  = bytemask(0, (offset + count - 1) % 8);
+    unsigned long long       total = 0;
+
+    if (first == last) return (unsigned long long) __builtin_popcount(bitstream[first] & head & tail);
+
+    if (head != 0xFF) total += (unsigned long long) __builtin_popcount(bitstream[first++] & head);
+    if (tail != 0xFF) total += (unsigned long long) __builtin_popcount(bitstream[last] & tail);
+    return total + popcount_bytes(bitstream + first, last - first + (tail == 0xFF));
+}
@@ -4,6 +4,86 @@
 #include <utilities.h>
 // clang-format on
 
+// the io_uring backend talks to the kernel through the raw system calls, it only needs the kernel's uapi header at compile time
+// and falls back to the synchronous calls at run time on kernels that lack or refuse io_uring, define FILEIO_NO_URING to leave it out
+#if !defined(FILEIO_NO_URING) && __has_include(<linux/io_uring.h>)
+    #define FILEIO_HAS_URING 1
+    #include <linux/io_uring.h>
+    #include <sys/syscall.h>
+#else
+    #define FILEIO_HAS_URING 0
+#endif
+
+// reads until nbytes bytes are in or the file ends, a single read() can come back with fewer bytes than asked for, on Linux it
+// never transfers more than 0x7FFFF000 bytes, and a signal can interrupt it before it reads anything
+// returns the number of bytes read, which is less than nbytes only at the end of the file, -1 if a read() fails
+static inline long long __read_fully(const int fdesc, unsigned char* const buffer, const unsigned long long nbytes) {
+    assert(buffer || !nbytes);
+    unsigned long long total = 0;
+    ssize_t            nread = 0;
+
+    while (total < nbytes) {
+        if ((nread = read(fdesc, buffer + total, nbytes - total)) > 0)
+            total += nread;
+        else if (!nread) // end of file
+            break;
+        else if (errno != EINTR)
+            return -1;
+    }
+    return (long long) total;
+}
+
+// writes until all nbytes bytes are out, like read(), a single write() may transfer fewer bytes than asked for
+static inline bool __write_fully(const int fdesc, const unsigned char* const buffer, const unsigned long long nbytes) {
+    assert(buffer || !nbytes);
+    unsigned long long total    = 0;
+    ssize_t            nwritten = 0;
+
+    while (total < nbytes) {
+        if ((nwritten = write(fdesc, buffer + total, nbytes - total)) > 0)
+            total += nwritten;
+        else if (!nwritten) { // no progress with bytes still pending, retrying could spin forever
+            errno = EIO;
+            return false;
+        } else if (errno != EINTR)
+            return false;
+    }
+    return true;
+}
+
+// gathers the iovecs into the file without concatenating them first, a writev() takes at most IOV_MAX iovecs and may stop short of
+// the total like write() does, so the iovecs are consumed as they go out, the written ones end up empty and a partially written
+// one gets advanced past the bytes that made it
+static inline bool __writev_fully(const int fdesc, struct iovec* restrict iovecs, unsigned long long count) {
+    assert(iovecs || !count);
+    ssize_t nwritten = 0;
+
+    while (count) {
+        if (!iovecs->iov_len) { // skipped up front, so that a 0 from writev() always means no progress
+            ++iovecs;
+            --count;
+            continue;
+        }
+        if ((nwritten = writev(fdesc, iovecs, (int) (count < IOV_MAX ? count : IOV_MAX))) == -1) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (!nwritten) { // like __write_fully(), a writev() that makes no progress is an error rather than a retry
+            errno = EIO;
+            return false;
+        }
+        for (; count && (size_t) nwritten >= iovecs->iov_len; ++iovecs, --count) { // skip over the iovecs written out in full
+            nwritten        -= (ssize_t) iovecs->iov_len;
+            iovecs->iov_len  = 0;
+        }
+        if (count) {
+            iovecs->iov_base  = (unsigned char*) iovecs->iov_base + nwritten;
+            iovecs->iov_len  -= nwritten;
+        }
+    }
+    return true;
+}
+
 static inline unsigned char* __read(const char* const fpath, long* const nreadbytes) {
     *nreadbytes             = 0;
     unsigned char* buffer   = 0;
@@ -26,9 +106,10 @@ static inline unsigned char* __read(const char* const fpath, long* const nreadby
         goto CLOSE_AND_RETURN;
     }
 
-    if ((nbytes = read(fdesc, buffer, filestat.st_size)) != -1) {
+    if ((nbytes = __read_fully(fdesc, buffer, filestat.st_size)) != -1) {
         *nreadbytes = nbytes;
-        assert(nbytes == filestat.st_size); // double checking
+        if (nbytes != filestat.st_size) // the file got shorter after the fstat()
+            fprintf(stderr, "Read only %ld of %ld bytes inside %s at line %d!\n", nbytes, filestat.st_size, __FUNCTION__, __LINE__);
     } else {
         fprintf(stderr, "Call to read() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
         free(buffer);
@@ -42,6 +123,219 @@ CLOSE_AND_RETURN:
     return buffer;
 }
 
+// maps the whole file read only instead of copying it into a heap buffer, the pages come straight from the page cache as they are
+// first touched, so the file is not resident twice and the caller can start on the first pages while the kernel reads ahead the rest
+// returns nullptr on failure, empty files get a zero length view that is not a nullptr, either way the view goes to __unmap() when done
+static inline const unsigned char* __map(const char* const fpath, unsigned long long* const nmappedbytes) {
+    assert(fpath);
+    assert(nmappedbytes);
+    *nmappedbytes                 = 0;
+    const unsigned char* buffer   = nullptr;
+    struct stat          filestat = {};
+    void*                mapping  = MAP_FAILED;
+
+    const int fdesc               = open(fpath, O_RDONLY);
+    if (fdesc == -1) {
+        fprintf(stderr, "Call to open() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+        return nullptr;
+    }
+
+    if (fstat(fdesc, &filestat)) {
+        fprintf(stderr, "Call to fstat() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+        goto CLOSE_AND_RETURN;
+    }
+
+    if (!filestat.st_size) { // mmap() refuses zero length mappings
+        buffer = (const unsigned char*) "";
+        goto CLOSE_AND_RETURN;
+    }
+
+    if ((mapping = mmap(nullptr, filestat.st_size, PROT_READ, MAP_PRIVATE, fdesc, 0)) == MAP_FAILED) {
+        fprintf(stderr, "Call to mmap() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+        goto CLOSE_AND_RETURN;
+    }
+
+    // the hints are best effort, the mapping works the same whether or not the kernel takes them, they are separate advice values
+    // rather than flags, hence a call for each
+    madvise(mapping, filestat.st_size, MADV_SEQUENTIAL); // read ahead aggressively and drop the pages behind early
+#ifdef MADV_HUGEPAGE
+    madvise(mapping, filestat.st_size, MADV_HUGEPAGE); // fewer TLB misses, where the filesystem can back its page cache with huge pages
+#endif
+
+    buffer        = (const unsigned char*) mapping;
+    *nmappedbytes = filestat.st_size;
+    // then, fall through the CLOSE_AND_RETURN label, the mapping outlives the file descriptor
+
+CLOSE_AND_RETURN:
+    if (close(fdesc)) fprintf(stderr, "Call to close() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+    return buffer;
+}
+
+// releases a view returned by __map(), nbytes must be the size __map() reported
+static inline bool __unmap(const unsigned char* const buffer, const unsigned long long nbytes) {
+    assert(buffer);
+    if (!nbytes) return true; // the zero length views of empty files are not mappings
+
+    if (munmap((void*) buffer, nbytes)) {
+        fprintf(stderr, "Call to munmap() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+        return false;
+    }
+    return true;
+}
+
+#ifndef FILEIO_CHUNK_SIZE // chunk size streamreader_open() picks when given 0, a multiple of the 64 KiB blocks compress() encodes
+    #define FILEIO_CHUNK_SIZE (1LLU << 22)
+#endif
+
+// one of the two buffers of a streamreader_t, the read ahead thread fills a chunk only while it is not full and the consumer
+// empties it by asking for the chunk after it
+typedef struct _stream_chunk {
+        unsigned char*     buffer;
+        unsigned long long nbytes;  // number of bytes read into the buffer
+        bool               is_full; // filled and not yet released by the consumer
+} stream_chunk_t;
+
+// yields a file in fixed size chunks with bounded memory, two chunks no matter how large the file is, while the consumer works on
+// one chunk a background thread reads the next one into the other, so the work on a chunk overlaps the read of the next
+// the reader is shared with its thread, so it must stay put between streamreader_open() and streamreader_close()
+typedef struct _streamreader {
+        stream_chunk_t     chunks[2];
+        unsigned long long chunk_size;
+        unsigned           next;        // the chunk streamreader_next() hands out next, the one before it is held by the consumer
+        bool               is_holding;  // has the consumer got a chunk it has not released yet
+        bool               is_threaded; // false if the read ahead thread could not be spawned, the chunks are then read on demand
+        bool               is_done;     // the end of the file has been reached or a read() failed, no more chunks will be filled
+        bool               is_failed;   // a read() failed
+        bool               is_stopping; // streamreader_close() is waiting for the read ahead thread to exit
+        int                fdesc;
+        pthread_t          thread;
+        pthread_mutex_t    lock;   // guards the chunks' nbytes and is_full and all the flags
+        pthread_cond_t     signal; // broadcast whenever a chunk gets filled or released, or the reader is stopping
+} streamreader_t;
+
+// reads a chunk, returns the number of bytes read, 0 at the end of the file and -1 on failure
+static inline long long streamreader_fill(streamreader_t* const restrict reader, stream_chunk_t* const restrict chunk) {
+    const long long nread = __read_fully(reader->fdesc, chunk->buffer, reader->chunk_size);
+    if (nread == -1) [[unlikely]]
+        fprintf(stderr, "Call to read() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+    return nread;
+}
+
+static inline void* streamreader_run(void* const context) { // has the signature pthread_create() expects
+    streamreader_t* const reader = (streamreader_t*) context;
+    long long             nread  = 0;
+
+    for (unsigned i = 0;; i ^= 1) { // the chunks get filled in turns, the same order the consumer takes them in
+        pthread_mutex_lock(&reader->lock);
+        while (reader->chunks[i].is_full && !reader->is_stopping) pthread_cond_wait(&reader->signal, &reader->lock);
+        const bool is_stopping = reader->is_stopping;
+        pthread_mutex_unlock(&reader->lock);
+        if (is_stopping) break;
+
+        nread = streamreader_fill(reader, reader->chunks + i); // the consumer does not touch a chunk that isn't full, no lock needed
+
+        pthread_mutex_lock(&reader->lock);
+        reader->chunks[i].nbytes  = nread > 0 ? (unsigned long long) nread : 0;
+        reader->chunks[i].is_full = true;
+        reader->is_failed         = nread == -1;
+        reader->is_done           = nread < (long long) reader->chunk_size; // a short chunk is the last one
+        pthread_cond_broadcast(&reader->signal);
+        const bool is_done = reader->is_done;
+        pthread_mutex_unlock(&reader->lock);
+        if (is_done) break;
+    }
+    return nullptr;
+}
+
+// opens the file and starts reading the first chunk in the background, a chunk_size of 0 picks FILEIO_CHUNK_SIZE
+static inline bool streamreader_open(
+    streamreader_t* const restrict reader, const char* const restrict fpath, const unsigned long long chunk_size
+) {
+    assert(reader);
+    assert(fpath);
+    memset(reader, 0U, sizeof(streamreader_t));
+    reader->chunk_size = chunk_size ? chunk_size : FILEIO_CHUNK_SIZE;
+
+    if ((reader->fdesc = open(fpath, O_RDONLY)) == -1) {
+        fprintf(stderr, "Call to open() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+        return false;
+    }
+    posix_fadvise(reader->fdesc, 0, 0, POSIX_FADV_SEQUENTIAL); // a best effort hint for a larger kernel read ahead window
+
+    reader->chunks[0].buffer = (unsigned char*) malloc(reader->chunk_size);
+    reader->chunks[1].buffer = (unsigned char*) malloc(reader->chunk_size);
+    if (!reader->chunks[0].buffer || !reader->chunks[1].buffer) {
+        fprintf(stderr, "Call to malloc() failed inside %s at line %d!\n", __FUNCTION__, __LINE__);
+        free(reader->chunks[0].buffer);
+        free(reader->chunks[1].buffer);
+        close(reader->fdesc);
+        return false;
+    }
+
+    pthread_mutex_init(&reader->lock, nullptr);
+    pthread_cond_init(&reader->signal, nullptr);
+    reader->is_threaded = !pthread_create(&reader->thread, nullptr, streamreader_run, reader);
+    return true;
+}
+
+// releases the chunk handed out by the previous call and returns the next one, which stays valid until the next call or
+// streamreader_close(), returns nullptr once the file is exhausted or a read() failed, streamreader_close() tells the two apart
+static inline const unsigned char* streamreader_next(streamreader_t* const restrict reader, unsigned long long* const restrict nbytes) {
+    assert(reader);
+    assert(nbytes);
+    *nbytes                     = 0;
+    const unsigned char* buffer = nullptr;
+    long long            nread  = 0;
+
+    if (!reader->is_threaded) [[unlikely]] { // read the chunk right now, into the first buffer every time
+        if (reader->is_done) return nullptr;
+        nread             = streamreader_fill(reader, reader->chunks);
+        reader->is_failed = nread == -1;
+        reader->is_done   = nread < (long long) reader->chunk_size;
+        if (nread <= 0) return nullptr;
+        *nbytes = nread;
+        return reader->chunks[0].buffer;
+    }
+
+    pthread_mutex_lock(&reader->lock);
+    if (reader->is_holding) { // hand the previous chunk back to the read ahead thread
+        reader->chunks[reader->next ^ 1].is_full = false;
+        reader->is_holding                       = false;
+        pthread_cond_broadcast(&reader->signal);
+    }
+    while (!reader->chunks[reader->next].is_full && !reader->is_done) pthread_cond_wait(&reader->signal, &reader->lock);
+
+    if (reader->chunks[reader->next].is_full && reader->chunks[reader->next].nbytes) {
+        buffer              = reader->chunks[reader->next].buffer;
+        *nbytes             = reader->chunks[reader->next].nbytes;
+        reader->is_holding  = true;
+        reader->next       ^= 1;
+    }
+    pthread_mutex_unlock(&reader->lock);
+    return buffer;
+}
+
+// stops the read ahead thread, frees the chunks and closes the file, can be called before the file is exhausted
+// returns false if any read() failed, i.e. the chunks handed out did not cover the whole file
+static inline bool streamreader_close(streamreader_t* const restrict reader) {
+    assert(reader);
+
+    if (reader->is_threaded) {
+        pthread_mutex_lock(&reader->lock);
+        reader->is_stopping = true;
+        pthread_cond_broadcast(&reader->signal);
+        pthread_mutex_unlock(&reader->lock);
+        pthread_join(reader->thread, nullptr);
+    }
+    pthread_cond_destroy(&reader->signal);
+    pthread_mutex_destroy(&reader->lock);
+
+    free(reader->chunks[0].buffer);
+    free(reader->chunks[1].buffer);
+    if (close(reader->fdesc)) fprintf(stderr, "Call to close() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+    return !reader->is_failed;
+}
+
 // a file format agnostic write routine to serialize binary image files, if a file with the specified name exists on disk, it will be overwritten
 static inline bool __write(const char* const filename, const unsigned char* const buffer, const long buffsize) {
     assert(filename); // too much??
@@ -50,9 +344,8 @@ static inline bool __write(const char* const filename, const unsigned char* cons
         return false; // fail if the buffer is a nullptr
     }
 
-    bool      is_success     = false; // has every step succeeded???
-    long      nbytes_written = 0;     // number of bytes serialized to the disk
-    const int fdesc          = open(filename, O_CREAT | O_WRONLY, S_IRUSR | S_IROTH | S_IWUSR | S_IWOTH);
+    bool      is_success = false; // has every step succeeded???
+    const int fdesc      = open(filename, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IROTH | S_IWUSR | S_IWOTH);
     // without explicitly specifying the mode_t, we had to use sudo to open the written images, open the file descriptor with create and write privileges
 
     if (fdesc == -1) {
@@ -60,17 +353,598 @@ static inline bool __write(const char* const filename, const unsigned char* cons
         goto CLOSE_AND_RETURN;
     }
 
-    nbytes_written = write(fdesc, buffer, buffsize);
-    if (nbytes_written == -1) {
+    if (!__write_fully(fdesc, buffer, buffsize)) {
         fprintf(stderr, "Call to write() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
         goto CLOSE_AND_RETURN;
     }
 
     // if the write was successful,
-    is_success = (buffsize == nbytes_written);
+    is_success = true;
     // then, fall through the CLOSE_AND_RETURN label
 
 CLOSE_AND_RETURN:
     close(fdesc);
     return is_success;
 }
+
+// an output file that takes the data in pieces, e.g. the compressed blocks of several workers, straight from where they are
+typedef struct _filewriter {
+        int                fdesc;
+        unsigned long long nbytes;   // number of bytes written so far
+        unsigned long long reserved; // number of bytes preallocated by filewriter_open()
+} filewriter_t;
+
+// creates the file or truncates an existing one, a non zero size_hint preallocates that many bytes on the disk so the file system
+// can lay the file out in one go instead of extending it write by write, the preallocation is a best effort that file systems
+// without fallocate() support just skip, the file size only ever reflects the bytes actually written
+static inline bool filewriter_open(
+    filewriter_t* const restrict writer, const char* const restrict fpath, const unsigned long long size_hint
+) {
+    assert(writer);
+    assert(fpath);
+    writer->nbytes   = 0;
+    writer->reserved = 0;
+
+    if ((writer->fdesc = open(fpath, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IROTH | S_IWUSR | S_IWOTH)) == -1) {
+        fprintf(stderr, "Call to open() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+        return false;
+    }
+    if (size_hint && !fallocate(writer->fdesc, FALLOC_FL_KEEP_SIZE, 0, (off_t) size_hint)) writer->reserved = size_hint;
+    return true;
+}
+
+static inline bool filewriter_write(
+    filewriter_t* const restrict writer, const unsigned char* const restrict buffer, const unsigned long long nbytes
+) {
+    assert(writer);
+    if (!__write_fully(writer->fdesc, buffer, nbytes)) {
+        fprintf(stderr, "Call to write() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+        return false;
+    }
+    writer->nbytes += nbytes;
+    return true;
+}
+
+// writes the iovecs in order, consuming them as __writev_fully() does
+static inline bool filewriter_writev(
+    filewriter_t* const restrict writer, struct iovec* const restrict iovecs, const unsigned long long count
+) {
+    assert(writer);
+    unsigned long long nbytes = 0;
+    for (unsigned long long i = 0; i < count; ++i) nbytes += iovecs[i].iov_len;
+
+    if (!__writev_fully(writer->fdesc, iovecs, count)) {
+        fprintf(stderr, "Call to writev() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+        return false;
+    }
+    writer->nbytes += nbytes;
+    return true;
+}
+
+// returns false if the file could not be closed cleanly, close() is where some file systems report deferred write errors
+static inline bool filewriter_close(filewriter_t* const writer) {
+    assert(writer);
+    bool is_success = true;
+
+    // the blocks preallocated past the end of the file stay allocated until it gets truncated
+    if (writer->reserved > writer->nbytes && ftruncate(writer->fdesc, (off_t) writer->nbytes)) {
+        fprintf(stderr, "Call to ftruncate() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+        is_success = false;
+    }
+    if (close(writer->fdesc)) {
+        fprintf(stderr, "Call to close() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+        is_success = false;
+    }
+    return is_success;
+}
+
+#if FILEIO_HAS_URING
+
+// an io_uring instance driven through the raw system calls, so liburing is not needed, the submission and completion queues are
+// rings shared with the kernel, the sqes are filled in place and published by advancing the submission queue tail, completions
+// are consumed by advancing the completion queue head
+typedef struct _uring {
+        int                  fdesc;
+        unsigned             nentries;  // capacity of the submission queue, the completion queue holds twice as many
+        unsigned             nqueued;   // sqes published but not yet handed to io_uring_enter()
+        unsigned             ninflight; // submissions the kernel has taken whose completions have not been reaped
+        unsigned*            sq_head;   // advanced by the kernel as it consumes the sqes
+        unsigned*            sq_tail;
+        unsigned*            sq_mask;
+        struct io_uring_sqe* sqes;
+        unsigned*            cq_head;
+        unsigned*            cq_tail;   // advanced by the kernel as it posts completions
+        unsigned*            cq_mask;
+        struct io_uring_cqe* cqes;
+        void*                sq_ring;
+        void*                cq_ring; // the same mapping as sq_ring on kernels with IORING_FEAT_SINGLE_MMAP
+        unsigned long long   sq_ring_size;
+        unsigned long long   cq_ring_size;
+} uring_t;
+
+static inline void uring_close(uring_t* const ring) {
+    assert(ring);
+    if (ring->sqes) munmap(ring->sqes, ring->nentries * sizeof(struct io_uring_sqe));
+    if (ring->cq_ring && ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_size);
+    if (ring->sq_ring) munmap(ring->sq_ring, ring->sq_ring_size);
+    close(ring->fdesc);
+    memset(ring, 0U, sizeof(uring_t));
+    ring->fdesc = -1;
+}
+
+// returns false without complaining when io_uring is unavailable, kernels before 5.6 lack it or IORING_OP_READ and IORING_OP_WRITE,
+// and seccomp filters or kernel.io_uring_disabled can refuse it at run time, the callers then fall back to the synchronous calls
+static inline bool uring_init(uring_t* const ring, const unsigned nentries) {
+    assert(ring);
+    assert(nentries);
+    struct io_uring_params params     = {};
+    const int              protection = PROT_READ | PROT_WRITE;
+    const int              flags      = MAP_SHARED | MAP_POPULATE; // the rings are shared with the kernel, prefaulted
+    unsigned long long     sqes_size  = 0;
+    unsigned*              sq_array   = nullptr; // maps queue slots to sqes
+    memset(ring, 0U, sizeof(uring_t));
+
+    if ((ring->fdesc = (int) syscall(__NR_io_uring_setup, nentries, &params)) == -1) return false;
+    if (!(params.features & IORING_FEAT_RW_CUR_POS)) { // came with IORING_OP_READ and IORING_OP_WRITE in 5.6
+        close(ring->fdesc);
+        ring->fdesc = -1;
+        return false;
+    }
+
+    ring->nentries     = params.sq_entries;
+    sqes_size          = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) { // both rings live in one mapping that must be large enough for either
+        if (ring->cq_ring_size > ring->sq_ring_size) ring->sq_ring_size = ring->cq_ring_size;
+        ring->cq_ring_size = ring->sq_ring_size;
+    }
+
+    ring->sq_ring = mmap(nullptr, ring->sq_ring_size, protection, flags, ring->fdesc, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) {
+        ring->sq_ring = nullptr;
+        goto FAIL;
+    }
+    ring->cq_ring = (params.features & IORING_FEAT_SINGLE_MMAP)
+                      ? ring->sq_ring
+                      : mmap(nullptr, ring->cq_ring_size, protection, flags, ring->fdesc, IORING_OFF_CQ_RING);
+    if (ring->cq_ring == MAP_FAILED) {
+        ring->cq_ring = nullptr;
+        goto FAIL;
+    }
+    ring->sqes = (struct io_uring_sqe*) mmap(nullptr, sqes_size, protection, flags, ring->fdesc, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        ring->sqes = nullptr;
+        goto FAIL;
+    }
+
+    ring->sq_head = (unsigned*) ((unsigned char*) ring->sq_ring + params.sq_off.head);
+    ring->sq_tail = (unsigned*) ((unsigned char*) ring->sq_ring + params.sq_off.tail);
+    ring->sq_mask = (unsigned*) ((unsigned char*) ring->sq_ring + params.sq_off.ring_mask);
+    ring->cq_head = (unsigned*) ((unsigned char*) ring->cq_ring + params.cq_off.head);
+    ring->cq_tail = (unsigned*) ((unsigned char*) ring->cq_ring + params.cq_off.tail);
+    ring->cq_mask = (unsigned*) ((unsigned char*) ring->cq_ring + params.cq_off.ring_mask);
+    ring->cqes    = (struct io_uring_cqe*) ((unsigned char*) ring->cq_ring + params.cq_off.cqes);
+
+    sq_array = (unsigned*) ((unsigned char*) ring->sq_ring + params.sq_off.array);
+    for (unsigned i = 0; i < ring->nentries; ++i) sq_array[i] = i; // an identity mapping lets the sqes be filled in queue order
+    return true;
+
+FAIL:
+    fprintf(stderr, "Call to mmap() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+    uring_close(ring);
+    return false;
+}
+
+// pins the buffers for IORING_OP_READ_FIXED and IORING_OP_WRITE_FIXED, which spares the kernel mapping them on every request
+// can fail with ENOMEM where the pinned pages count against RLIMIT_MEMLOCK, the plain opcodes then do the same job
+static inline bool uring_register_buffers(uring_t* const restrict ring, const struct iovec* const restrict iovecs, const unsigned count) {
+    assert(ring);
+    assert(iovecs);
+    return !syscall(__NR_io_uring_register, ring->fdesc, IORING_REGISTER_BUFFERS, iovecs, count);
+}
+
+// queues a read or a write of nbytes at offset, buffer_index is the index of a registered buffer the bytes lie in for the _FIXED
+// opcodes and ignored otherwise, returns false if the submission queue is full, the request only starts at uring_submit()
+static inline bool uring_queue_rw(
+    uring_t* const restrict  ring,
+    const unsigned char      opcode,
+    const int                fdesc,
+    const void* const        buffer,
+    const unsigned           nbytes,
+    const unsigned long long offset,
+    const unsigned short     buffer_index,
+    const unsigned long long user_data // handed back with the completion
+) {
+    assert(ring);
+    const unsigned tail = *ring->sq_tail; // only ever written by us
+    if (tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) == ring->nentries) [[unlikely]]
+        return false;
+
+    struct io_uring_sqe* const sqe = ring->sqes + (tail & *ring->sq_mask);
+    memset(sqe, 0U, sizeof(struct io_uring_sqe));
+    sqe->opcode    = opcode;
+    sqe->fd        = fdesc;
+    sqe->addr      = (unsigned long long) (uintptr_t) buffer;
+    sqe->len       = nbytes;
+    sqe->off       = offset;
+    sqe->buf_index = buffer_index;
+    sqe->user_data = user_data;
+    __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE); // the kernel must see the sqe before the new tail
+    ring->nqueued++;
+    return true;
+}
+
+// hands the queued requests to the kernel and, with min_complete > 0, waits until that many completions are available
+static inline bool uring_submit(uring_t* const ring, const unsigned min_complete) {
+    assert(ring);
+    const unsigned flags      = min_complete ? IORING_ENTER_GETEVENTS : 0U;
+    long           nsubmitted = 0;
+
+    while ((nsubmitted = syscall(__NR_io_uring_enter, ring->fdesc, ring->nqueued, min_complete, flags, nullptr, 0)) == -1) {
+        if (errno != EINTR) {
+            fprintf(stderr, "Call to io_uring_enter() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+            return false;
+        }
+    }
+    ring->nqueued   -= (unsigned) nsubmitted;
+    ring->ninflight += (unsigned) nsubmitted;
+    return true;
+}
+
+// takes the oldest completion off the completion queue, returns false if there is none yet, result is what the equivalent system
+// call would have returned except that errors come back as -errno
+static inline bool uring_reap(uring_t* const restrict ring, unsigned long long* const restrict user_data, int* const restrict result) {
+    assert(ring);
+    const unsigned head = *ring->cq_head; // only ever written by us
+    if (head == __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE)) return false;
+
+    const struct io_uring_cqe* const cqe = ring->cqes + (head & *ring->cq_mask);
+    *user_data                           = cqe->user_data;
+    *result                              = cqe->res;
+    __atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE); // the cqe may be reused once the head moves past it
+    ring->ninflight--;
+    return true;
+}
+
+// submits whatever is queued and blocks until a completion can be reaped, returns false if nothing is outstanding
+static inline bool uring_wait(uring_t* const restrict ring, unsigned long long* const restrict user_data, int* const restrict result) {
+    assert(ring);
+    while (!uring_reap(ring, user_data, result)) {
+        if (!ring->nqueued && !ring->ninflight) return false;
+        if (!uring_submit(ring, 1)) return false;
+    }
+    return true;
+}
+
+#endif // FILEIO_HAS_URING
+
+#ifndef FILEIO_URING_DEPTH // most reads or writes filebatch_t and __write_batch() keep in flight at once
+    #define FILEIO_URING_DEPTH (16U)
+#endif
+
+// a chunk of one of the files of a filebatch_t
+typedef struct _filechunk {
+        const unsigned char* buffer;
+        unsigned long long   file;    // index of the file in the batch
+        unsigned long long   offset;  // where in the file the chunk starts
+        unsigned long long   nbytes;  // 0 only for the single chunk of an empty file
+        bool                 is_last; // the last chunk of the file
+} filechunk_t;
+
+// a file being read into a chunk sized buffer, one read per file is in flight so the chunks of each file arrive in order
+typedef struct _filebatch_slot {
+        unsigned char*     buffer;
+        unsigned long long file;
+        unsigned long long fsize;
+        unsigned long long offset; // where the read in flight, or the chunk held by the caller, starts
+        long long          result; // bytes the synchronous read brought in, -1 if it failed
+        int                fdesc;
+        bool               is_ready; // the synchronous read has completed and the chunk has not been handed out yet
+} filebatch_slot_t;
+
+// reads a list of files in chunks with up to FILEIO_URING_DEPTH files in flight at once through io_uring, the caller compresses a
+// chunk while the reads of the other files continue, memory stays bounded at one chunk per file in flight
+// where io_uring is unavailable, the files are read one chunk at a time with pread() in the order they were listed
+typedef struct _filebatch {
+        const char* const* fpaths;
+        unsigned long long nfiles;
+        unsigned long long nassigned; // files handed to a slot so far
+        unsigned long long chunk_size;
+        unsigned char*     buffers; // one allocation split between the slots
+        unsigned           nslots;
+        unsigned           held; // the slot whose chunk the caller holds, nslots if none
+        bool               is_uring;
+        bool               is_registered; // the slot buffers are registered with the ring, reads use IORING_OP_READ_FIXED
+        bool               is_failed;     // a file could not be opened or read, its chunks are incomplete or missing
+        filebatch_slot_t   slots[FILEIO_URING_DEPTH];
+#if FILEIO_HAS_URING
+        uring_t ring;
+#endif
+} filebatch_t;
+
+// starts the read of the next chunk of the file in the slot
+static inline void filebatch_submit(filebatch_t* const batch, const unsigned index) {
+    filebatch_slot_t* const  slot   = batch->slots + index;
+    const unsigned long long nbytes = slot->fsize - slot->offset < batch->chunk_size ? slot->fsize - slot->offset : batch->chunk_size;
+
+#if FILEIO_HAS_URING
+    if (batch->is_uring) { // at most one request per slot is in flight, so the queue always has room
+        uring_queue_rw(
+            &batch->ring,
+            batch->is_registered ? IORING_OP_READ_FIXED : IORING_OP_READ,
+            slot->fdesc,
+            slot->buffer,
+            (unsigned) nbytes,
+            slot->offset,
+            (unsigned short) index,
+            index
+        );
+        return;
+    }
+#endif
+    slot->result   = 0;
+    slot->is_ready = true;
+    for (ssize_t nread = 0; (unsigned long long) slot->result < nbytes; slot->result += nread) {
+        if ((nread = pread(slot->fdesc, slot->buffer + slot->result, nbytes - slot->result, slot->offset + slot->result)) > 0) continue;
+        if (!nread) break; // the file got shorter after the fstat()
+        if (errno == EINTR) {
+            nread = 0;
+            continue;
+        }
+        slot->result = -1;
+        break;
+    }
+}
+
+// opens the next file that can be opened and starts reading its first chunk into the slot, returns false if no files are left
+static inline bool filebatch_assign(filebatch_t* const batch, const unsigned index) {
+    filebatch_slot_t* const slot     = batch->slots + index;
+    struct stat             filestat = {};
+
+    while (batch->nassigned < batch->nfiles) {
+        slot->file = batch->nassigned++;
+        if ((slot->fdesc = open(batch->fpaths[slot->file], O_RDONLY)) == -1) {
+            fprintf(stderr, "Call to open() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+            batch->is_failed = true;
+            continue;
+        }
+        if (fstat(slot->fdesc, &filestat)) {
+            fprintf(stderr, "Call to fstat() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+            close(slot->fdesc);
+            batch->is_failed = true;
+            continue;
+        }
+        slot->fsize  = filestat.st_size;
+        slot->offset = 0;
+        filebatch_submit(batch, index);
+        return true;
+    }
+    slot->fdesc = -1;
+    return false;
+}
+
+// reads the files at fpaths, which must outlive the batch, a chunk_size of 0 picks FILEIO_CHUNK_SIZE, a depth of 0 picks
+// FILEIO_URING_DEPTH and a depth of 1 reads with pread() as the fallback does, since there are no other reads to overlap with
+static inline bool filebatch_open(
+    filebatch_t* const restrict       batch,
+    const char* const* const restrict fpaths,
+    const unsigned long long          nfiles,
+    const unsigned long long          chunk_size,
+    const unsigned                    depth
+) {
+    assert(batch);
+    assert(fpaths || !nfiles);
+    memset(batch, 0U, sizeof(filebatch_t));
+    batch->fpaths     = fpaths;
+    batch->nfiles     = nfiles;
+    batch->chunk_size = chunk_size ? chunk_size : FILEIO_CHUNK_SIZE;
+    batch->nslots     = depth && depth < FILEIO_URING_DEPTH ? depth : FILEIO_URING_DEPTH;
+    if (batch->nslots > nfiles) batch->nslots = nfiles ? (unsigned) nfiles : 1;
+    assert(batch->chunk_size <= (1LLU << 30)); // the largest buffer that can be registered, the length of a request is 32 bits wide
+
+#if FILEIO_HAS_URING
+    if (depth != 1 && batch->nslots > 1) batch->is_uring = uring_init(&batch->ring, batch->nslots);
+#endif
+    if (!batch->is_uring) batch->nslots = 1;
+    batch->held = batch->nslots;
+
+    if (!(batch->buffers = (unsigned char*) malloc(batch->nslots * batch->chunk_size))) {
+        fprintf(stderr, "Call to malloc() failed inside %s at line %d!\n", __FUNCTION__, __LINE__);
+#if FILEIO_HAS_URING
+        if (batch->is_uring) uring_close(&batch->ring);
+#endif
+        return false;
+    }
+
+#if FILEIO_HAS_URING
+    if (batch->is_uring) {
+        struct iovec iovecs[FILEIO_URING_DEPTH]; // NOLINT(cppcoreguidelines-init-variables)
+        for (unsigned i = 0; i < batch->nslots; ++i) {
+            iovecs[i].iov_base = batch->buffers + i * batch->chunk_size;
+            iovecs[i].iov_len  = batch->chunk_size;
+        }
+        batch->is_registered = uring_register_buffers(&batch->ring, iovecs, batch->nslots);
+    }
+#endif
+
+    for (unsigned i = 0; i < batch->nslots; ++i) {
+        batch->slots[i].buffer = batch->buffers + i * batch->chunk_size;
+        filebatch_assign(batch, i);
+    }
+    return true;
+}
+
+// releases the chunk handed out by the previous call and fills in the next one, chunks of different files arrive in the order their
+// reads complete, the chunks of each file in order, returns false once every file has been read, the chunk's buffer stays valid
+// until the next call or filebatch_close()
+static inline bool filebatch_next(filebatch_t* const restrict batch, filechunk_t* const restrict chunk) {
+    assert(batch);
+    assert(chunk);
+    filebatch_slot_t* slot  = nullptr;
+    unsigned          index = batch->nslots;
+    long long         nread = 0;
+
+    if (batch->held != batch->nslots) { // start reading the rest of the file or the next file into the released slot
+        slot = batch->slots + batch->held;
+        if (slot->offset < slot->fsize)
+            filebatch_submit(batch, batch->held);
+        else {
+            close(slot->fdesc);
+            filebatch_assign(batch, batch->held);
+        }
+        batch->held = batch->nslots;
+    }
+
+#if FILEIO_HAS_URING
+    if (batch->is_uring) {
+        unsigned long long user_data = 0;
+        int                result    = 0;
+        if (!uring_wait(&batch->ring, &user_data, &result)) {
+            if (batch->ring.nqueued || batch->ring.ninflight) batch->is_failed = true; // io_uring_enter() failed
+            return false;
+        }
+        index = (unsigned) user_data;
+        nread = result;
+        if (result < 0) errno = -result;
+    }
+#endif
+    if (!batch->is_uring) {
+        if (!batch->slots[0].is_ready) return false;
+        batch->slots[0].is_ready = false;
+        index                    = 0;
+        nread                    = batch->slots[0].result;
+    }
+
+    slot = batch->slots + index;
+    if (nread < 0) [[unlikely]] { // give up on the file, its remaining chunks are skipped
+        fprintf(stderr, "Read of %s failed inside %s at line %d!; errno %d\n", batch->fpaths[slot->file], __FUNCTION__, __LINE__, errno);
+        batch->is_failed = true;
+        nread            = 0;
+        slot->fsize      = slot->offset;
+    } else if (!nread && slot->offset < slot->fsize) // the file got shorter after the fstat()
+        slot->fsize = slot->offset;
+
+    chunk->buffer  = slot->buffer;
+    chunk->file    = slot->file;
+    chunk->offset  = slot->offset;
+    chunk->nbytes  = (unsigned long long) nread;
+    slot->offset  += (unsigned long long) nread; // a short read leaves the rest of the chunk to the next read
+    chunk->is_last = slot->offset >= slot->fsize;
+    batch->held    = index;
+    return true;
+}
+
+// can be called before every chunk has been handed out, returns false if any file could not be opened or read in full
+static inline bool filebatch_close(filebatch_t* const batch) {
+    assert(batch);
+#if FILEIO_HAS_URING
+    if (batch->is_uring) {
+        unsigned long long user_data = 0;
+        int                result    = 0;
+        while (uring_wait(&batch->ring, &user_data, &result)) continue; // the buffers must not be freed under reads in flight
+        uring_close(&batch->ring);
+    }
+#endif
+    for (unsigned i = 0; i < batch->nslots; ++i)
+        if (batch->slots[i].fdesc != -1) close(batch->slots[i].fdesc);
+    free(batch->buffers);
+    return !batch->is_failed;
+}
+
+// writes each buffer into a file of its own, truncating existing files, through io_uring with up to FILEIO_URING_DEPTH writes in
+// flight where it is available and with __write() one file after another where it is not, the buffers belong to the caller and
+// are written once each, so they are not registered, pinning them would cost more than it saves
+// returns false if any of the files could not be written in full
+static inline bool __write_batch(
+    const char* const* const restrict          fpaths,
+    const unsigned char* const* const restrict buffers,
+    const unsigned long long* const restrict   sizes,
+    const unsigned long long                   count
+) {
+    assert(fpaths || !count);
+    bool is_success = true;
+
+#if FILEIO_HAS_URING
+    uring_t ring = {};
+    if (count > 1 && uring_init(&ring, FILEIO_URING_DEPTH)) {
+        struct { // NOLINT(cppcoreguidelines-init-variables)
+                unsigned long long file;
+                unsigned long long offset;
+                int                fdesc; // -1 while the slot is idle
+        } slots[FILEIO_URING_DEPTH];
+        unsigned           idle[FILEIO_URING_DEPTH];              // NOLINT(cppcoreguidelines-init-variables)
+        unsigned           nidle = FILEIO_URING_DEPTH, index = 0; // NOLINT(readability-isolate-declaration)
+        unsigned long long next = 0, nbytes = 0, user_data = 0;   // NOLINT(readability-isolate-declaration)
+        int                result = 0;
+        for (unsigned i = 0; i < FILEIO_URING_DEPTH; ++i) {
+            idle[i]        = i;
+            slots[i].fdesc = -1;
+        }
+
+        for (;;) {
+            for (; nidle && next < count; ++next) { // put every free slot to work on a file of its own
+                if (!buffers[next] || !sizes[next]) { // nothing to write but the file still gets created or truncated
+                    is_success &= __write(fpaths[next], (const unsigned char*) "", 0);
+                    continue;
+                }
+                index               = idle[--nidle];
+                slots[index].file   = next;
+                slots[index].offset = 0;
+                if ((slots[index].fdesc = open(fpaths[next], O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IROTH | S_IWUSR | S_IWOTH)) == -1) {
+                    fprintf(stderr, "Call to open() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+                    is_success    = false;
+                    idle[nidle++] = index;
+                    continue;
+                }
+                nbytes = sizes[next] < (1LLU << 30) ? sizes[next] : (1LLU << 30); // the length of a request is 32 bits wide
+                uring_queue_rw(&ring, IORING_OP_WRITE, slots[index].fdesc, buffers[next], (unsigned) nbytes, 0, 0, index);
+            }
+            if (!uring_wait(&ring, &user_data, &result)) break;
+
+            index = (unsigned) user_data;
+            if (result <= 0) { // a write that moves nothing would never finish the file
+                fprintf(
+                    stderr,
+                    "Write to %s failed inside %s at line %d!; errno %d\n",
+                    fpaths[slots[index].file],
+                    __FUNCTION__,
+                    __LINE__,
+                    -result
+                );
+                is_success = false;
+            } else if ((slots[index].offset += result) < sizes[slots[index].file]) { // a short write, queue the rest
+                nbytes = sizes[slots[index].file] - slots[index].offset;
+                nbytes = nbytes < (1LLU << 30) ? nbytes : (1LLU << 30);
+                uring_queue_rw(
+                    &ring,
+                    IORING_OP_WRITE,
+                    slots[index].fdesc,
+                    buffers[slots[index].file] + slots[index].offset,
+                    (unsigned) nbytes,
+                    slots[index].offset,
+                    0,
+                    index
+                );
+                continue;
+            }
+            if (close(slots[index].fdesc)) {
+                fprintf(stderr, "Call to close() failed inside %s at line %d!; errno %d\n", __FUNCTION__, __LINE__, errno);
+                is_success = false;
+            }
+            slots[index].fdesc = -1;
+            idle[nidle++]      = index;
+        }
+
+        if (ring.ninflight || ring.nqueued) is_success = false; // io_uring_enter() failed, the files left in the slots are incomplete
+        for (unsigned i = 0; i < FILEIO_URING_DEPTH; ++i)
+            if (slots[i].fdesc != -1) close(slots[i].fdesc);
+        uring_close(&ring);
+        return is_success;
+    }
+#endif
+
+    for (unsigned long long i = 0; i < count; ++i)
+        is_success &= __write(fpaths[i], buffers[i] ? buffers[i] : (const unsigned char*) "", buffers[i] ? (long) sizes[i] : 0);
+    return is_success;
+}
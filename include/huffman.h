@@ -1,6 +1,7 @@
 #pragma once
 
 // clang-format off
+#include <bitops.h>
 #include <fileio.h>
 // clang-format on
 
@@ -16,28 +17,56 @@
 
 #define BYTECOUNT                          (256LLU)
 #define GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY (1LLU << 10) // number of btnode_t s a stack based priority queue can accomodate
+#define HUFFMAN_BLOCK_SIZE                 (1LLU << 16) // number of input bytes that get encoded with the same code table
+#ifndef HUFFMAN_MAX_CODE_LENGTH // longest code compress() will emit, trees deeper than this are replaced by length limited codes
+    #define HUFFMAN_MAX_CODE_LENGTH (12LLU)
+#endif
+#define HUFFMAN_SYMBOLS_PER_FLUSH (BITIO_MAX_BITS / HUFFMAN_MAX_CODE_LENGTH) // codes that fit in the accumulator between flushes
+#ifndef HUFFMAN_DECODE_TABLE_BITS // width of the primary decode table, longer codes spill over to secondary tables
+    #define HUFFMAN_DECODE_TABLE_BITS (11LLU)
+#endif
 
-// represents a Huffman node.
-typedef struct _hnode {
-        unsigned long long symbol; // will be (0, UCHAR_MAX) for leaf nodes, and will be UINT32_MAX for others
-        unsigned long long frequency;
-} hnode_t;
+#define HUFFMAN_MULTI_SYMBOLS (4LLU) // most symbols a multi symbol decode table entry can resolve
+#ifndef HUFFMAN_HISTOGRAM_TABLES // number of sub tables scan_frequencies() spreads consecutive bytes over
+    #define HUFFMAN_HISTOGRAM_TABLES (4LLU)
+#endif
+#define HUFFMAN_HISTOGRAM_CHUNK (1LLU << 31) // bytes the 32 bit sub tables can count before they must be folded into the totals
+#ifndef HUFFMAN_PQUEUE_ARITY // number of children per node in dpqueue_t, 4 of them take half a cache line, 8 a whole one
+    #define HUFFMAN_PQUEUE_ARITY (4LLU)
+#endif
+#ifndef HUFFMAN_PQUEUE_LAZY // when non zero, pqueue_t only ever touches the slots it uses, 0 zeroes the whole buffer on init and clean
+    #define HUFFMAN_PQUEUE_LAZY (1)
+#endif
+#define HUFFMAN_MAX_THREADS     (64LLU)     // most threads scan_frequencies_parallel() will split a buffer across
+#define HUFFMAN_THREAD_MIN_SIZE (1LLU << 20) // smallest slice worth a thread of its own, below this spawning costs more than it saves
+
+static_assert(HUFFMAN_MAX_CODE_LENGTH >= 8);  // BYTECOUNT symbols need at least 8 bit codes
+static_assert(HUFFMAN_MAX_CODE_LENGTH <= 16); // hcode_t.code is an unsigned short, so longer codes cannot be represented
+static_assert(HUFFMAN_DECODE_TABLE_BITS <= HUFFMAN_MAX_CODE_LENGTH);
+static_assert(HUFFMAN_PQUEUE_ARITY >= 2 && !(HUFFMAN_PQUEUE_ARITY & (HUFFMAN_PQUEUE_ARITY - 1))); // a power of 2 divides cache lines
+static_assert(HUFFMAN_HISTOGRAM_TABLES >= 1 && 16 % HUFFMAN_HISTOGRAM_TABLES == 0); // every 16 byte round must visit each sub table equally
 
-static_assert(sizeof(hnode_t) == 16);
-static_assert(offsetof(hnode_t, symbol) == 0);
-static_assert(offsetof(hnode_t, frequency) == 8);
+// a secondary table of depth d hangs off a complete subtree that has at least d + 1 leaves, so with BYTECOUNT leaves to go around,
+// the secondary tables can at most take up this many entries
+#define HUFFMAN_DECODE_TABLE_CAPACITY                                                                                                     \
+    ((1LLU << HUFFMAN_DECODE_TABLE_BITS) +                                                                                                \
+     (BYTECOUNT / (HUFFMAN_MAX_CODE_LENGTH - HUFFMAN_DECODE_TABLE_BITS + 1)) * (1LLU << (HUFFMAN_MAX_CODE_LENGTH - HUFFMAN_DECODE_TABLE_BITS)))
+
+#define BTNODE_INTERNAL (0xFFFFU) // symbol of the nodes that are not leaves
 
 // represents a binary tree node, this is the type that will be used to build the Huffman tree using a priority queue
+// children are referred to by their index in the tree's buffer rather than by pointers, the builders always place two siblings
+// next to each other, so the right child needs no index of its own and a whole 511 node tree fits in 4 KiBs
 typedef struct _btnode {
-        struct _btnode* left;
-        struct _btnode* right;
-        hnode_t         data;
+        unsigned       frequency; // the trees get built per block, so 32 bits are plenty
+        unsigned short left;      // index of the left child, the right child is at left + 1, meaningless for leaves
+        unsigned short symbol;    // will be (0, UCHAR_MAX) for leaf nodes, and will be BTNODE_INTERNAL for others
 } btnode_t;
 
-static_assert(sizeof(btnode_t) == 16 + sizeof(hnode_t));
-static_assert(offsetof(btnode_t, left) == 0);
-static_assert(offsetof(btnode_t, right) == 8);
-static_assert(offsetof(btnode_t, data) == 16);
+static_assert(sizeof(btnode_t) == 8);
+static_assert(offsetof(btnode_t, frequency) == 0);
+static_assert(offsetof(btnode_t, left) == 4);
+static_assert(offsetof(btnode_t, symbol) == 6);
 
 // represents a binary tree, to represent the Huffman tree
 typedef struct _bintree {
@@ -63,6 +92,32 @@ static_assert(offsetof(hcode_t, is_used) == 0);
 static_assert(offsetof(hcode_t, length) == 1);
 static_assert(offsetof(hcode_t, code) == 2);
 
+// represents an entry in the decode tables, indexed by the next HUFFMAN_DECODE_TABLE_BITS bits of the stream
+typedef struct _hdecode {
+        unsigned short value;   // the decoded symbol, or the offset of the secondary table when subbits is not 0
+        unsigned char  length;  // length of the complete code, i.e. the number of bits the symbol consumes
+        unsigned char  subbits; // width of the secondary table that resolves the codes sharing this prefix, 0 for symbols
+} hdecode_t;
+
+static_assert(sizeof(hdecode_t) == 4);
+static_assert(offsetof(hdecode_t, value) == 0);
+static_assert(offsetof(hdecode_t, length) == 2);
+static_assert(offsetof(hdecode_t, subbits) == 3);
+
+// represents an entry in the multi symbol decode table, resolves every code that fits completely in the next
+// HUFFMAN_DECODE_TABLE_BITS bits of the stream, up to HUFFMAN_MULTI_SYMBOLS of them
+typedef struct _hmulti {
+        unsigned char symbols[HUFFMAN_MULTI_SYMBOLS]; // the decoded symbols in stream order, written out with a single store
+        unsigned char count;                          // number of symbols resolved, 0 when the first code does not fit
+        unsigned char length;                         // total length of the resolved codes
+        unsigned char reserved[2];
+} hmulti_t;
+
+static_assert(sizeof(hmulti_t) == 8);
+static_assert(offsetof(hmulti_t, symbols) == 0);
+static_assert(offsetof(hmulti_t, count) == 4);
+static_assert(offsetof(hmulti_t, length) == 5);
+
 typedef struct _pqueue {
         unsigned  count;
         unsigned  capacity;
@@ -74,11 +129,23 @@ static_assert(offsetof(pqueue_t, count) == 0);
 static_assert(offsetof(pqueue_t, capacity) == 4);
 static_assert(offsetof(pqueue_t, tree) == 8);
 
+// a d-ary heap of btnode_t s, the children of a node sit next to each other in HUFFMAN_PQUEUE_ARITY * sizeof(btnode_t) bytes
+typedef struct _dpqueue {
+        unsigned  count;
+        unsigned  capacity;
+        btnode_t* tree; // the root is at HUFFMAN_PQUEUE_ARITY - 1 slots into the buffer, so every group of siblings is aligned
+} dpqueue_t;
+
+static_assert(sizeof(dpqueue_t) == 16);
+static_assert(offsetof(dpqueue_t, count) == 0);
+static_assert(offsetof(dpqueue_t, capacity) == 4);
+static_assert(offsetof(dpqueue_t, tree) == 8);
+
 //-------------------------------------------------------------------------------------------------------------------------------//
 //                                                      MISCELLANEOUS PRELIMINARIES                                              //
 //-------------------------------------------------------------------------------------------------------------------------------//
 
-static inline void  scan_frequencies( // the first step in Huffman encoding is the determination of symbol frequencies
+static inline void  scan_frequencies_single( // the first step in Huffman encoding is the determination of symbol frequencies
     const unsigned char* const restrict buffer,
      const unsigned long long size,
      unsigned long long* const restrict frequencies // could be a stack based or heap allocated array
@@ -89,12 +156,112 @@ static inline void  scan_frequencies( // the first step in Huffman encoding is t
     for (unsigned long long i = 0; i < size; ++i) frequencies[buffer[i]]++;
 }
 
+// with a single table, a run of the same byte makes every increment wait on the store of the previous one, spreading consecutive
+// bytes over HUFFMAN_HISTOGRAM_TABLES sub tables lets that many increments of the same counter be in flight at once
+static inline void scan_frequencies(
+    const unsigned char* const restrict buffer,
+    const unsigned long long size,
+    unsigned long long* const restrict frequencies // could be a stack based or heap allocated array
+) {
+    assert(buffer);
+    assert(size);
+
+    unsigned           counts[HUFFMAN_HISTOGRAM_TABLES][BYTECOUNT]; // NOLINT(cppcoreguidelines-init-variables)
+    unsigned long long lo = 0, hi = 0, i = 0, end = 0;              // NOLINT(readability-isolate-declaration)
+
+    memset(frequencies, 0U, sizeof(unsigned long long) * BYTECOUNT);
+    for (unsigned long long offset = 0; offset < size; offset += HUFFMAN_HISTOGRAM_CHUNK) {
+        end = (size - offset) < HUFFMAN_HISTOGRAM_CHUNK ? size : offset + HUFFMAN_HISTOGRAM_CHUNK;
+        memset(counts, 0U, sizeof(counts));
+
+        for (i = offset; i + 16 <= end; i += 16) { // two 8 byte loads per round, bytes are picked out with shifts
+            memcpy(&lo, buffer + i, sizeof(unsigned long long));
+            memcpy(&hi, buffer + i + 8, sizeof(unsigned long long));
+            for (unsigned j = 0; j < 8; ++j) counts[j % HUFFMAN_HISTOGRAM_TABLES][(unsigned char) (lo >> (j * 8))]++;
+            for (unsigned j = 0; j < 8; ++j) counts[(j + 8) % HUFFMAN_HISTOGRAM_TABLES][(unsigned char) (hi >> (j * 8))]++;
+        }
+        for (; i < end; ++i) counts[i % HUFFMAN_HISTOGRAM_TABLES][buffer[i]]++;
+
+        for (unsigned s = 0; s < BYTECOUNT; ++s) {
+            for (unsigned t = 0; t < HUFFMAN_HISTOGRAM_TABLES; ++t) frequencies[s] += counts[t][s];
+        }
+    }
+}
+
+// a slice of the buffer and the private table its thread counts into, aligned to cache lines so neighbouring threads never share one
+typedef struct _histogram_task {
+        const unsigned char* buffer;
+        unsigned long long   size;
+        alignas(64) unsigned long long frequencies[BYTECOUNT];
+} histogram_task_t;
+
+static_assert(sizeof(histogram_task_t) % 64 == 0);
+static_assert(offsetof(histogram_task_t, frequencies) % 64 == 0);
+
+static inline void* histogram_task_run(void* const task) { // has the signature pthread_create() expects
+    histogram_task_t* const histogram = (histogram_task_t*) task;
+    scan_frequencies(histogram->buffer, histogram->size, histogram->frequencies);
+    return nullptr;
+}
+
+// splits the buffer into up to nthreads slices, the calling thread counts the first one and spawned threads the rest
+// 0 threads picks one per online processor. the totals are exact integer sums, so they are identical to those of scan_frequencies()
+// for any thread count, slices whose thread could not be spawned are counted on the calling thread
+// the 2 KiB per thread tasks are heap allocated, a single slice or a failed allocation falls back to scan_frequencies()
+static inline void scan_frequencies_parallel(
+    const unsigned char* const restrict buffer,
+    const unsigned long long size,
+    unsigned long long* const restrict frequencies,
+    unsigned long long nthreads
+) {
+    assert(buffer);
+    assert(size);
+
+    histogram_task_t*        tasks                           = nullptr;
+    pthread_t                threads[HUFFMAN_MAX_THREADS]    = { 0 };
+    bool                     is_spawned[HUFFMAN_MAX_THREADS] = { false };
+    const unsigned long long nslices                         = (size + HUFFMAN_THREAD_MIN_SIZE - 1) / HUFFMAN_THREAD_MIN_SIZE;
+
+    if (!nthreads) {
+        const long nprocessors = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads               = nprocessors > 0 ? (unsigned long long) nprocessors : 1;
+    }
+    if (nthreads > HUFFMAN_MAX_THREADS) nthreads = HUFFMAN_MAX_THREADS;
+    if (nthreads > nslices) nthreads = nslices;
+    if (nthreads == 1 || !(tasks = (histogram_task_t*) aligned_alloc(alignof(histogram_task_t), nthreads * sizeof(histogram_task_t)))) {
+        scan_frequencies(buffer, size, frequencies);
+        return;
+    }
+
+    // slices start on cache line boundaries (relative to the buffer) so no two threads read the same line
+    const unsigned long long slice  = ((size + nthreads - 1) / nthreads + 63) & ~63LLU;
+    unsigned long long       ntasks = 0;
+    for (unsigned long long offset = 0; offset < size; offset += slice) {
+        tasks[ntasks].buffer = buffer + offset;
+        tasks[ntasks].size   = (size - offset) < slice ? (size - offset) : slice;
+        ntasks++;
+    }
+
+    for (unsigned long long t = 1; t < ntasks; ++t) is_spawned[t] = !pthread_create(threads + t, nullptr, histogram_task_run, tasks + t);
+    histogram_task_run(tasks);
+
+    memset(frequencies, 0U, sizeof(unsigned long long) * BYTECOUNT);
+    for (unsigned long long t = 0; t < ntasks; ++t) { // always reduced in slice order
+        if (is_spawned[t])
+            pthread_join(threads[t], nullptr);
+        else if (t) [[unlikely]]
+            histogram_task_run(tasks + t);
+        for (unsigned s = 0; s < BYTECOUNT; ++s) frequencies[s] += tasks[t].frequencies[s];
+    }
+    free(tasks);
+}
+
 //-------------------------------------------------------------------------------------------------------------------------------//
 //                  AN ALTERNATIVE IMPLEMENTATION OF PRIORITY QUEUE THAT USES STACK FOR BETTER PERFORMANCE                       //
 //-------------------------------------------------------------------------------------------------------------------------------//
 
 [[nodiscard]] static inline bool compare(const btnode_t child, const btnode_t parent) {
-    return child.data.frequency < parent.data.frequency; // we need the priority queue to yield the node with smallest frequency first
+    return child.frequency < parent.frequency; // we need the priority queue to yield the node with smallest frequency first
     // hence the less than operator
 }
 
@@ -105,7 +272,9 @@ static inline void  scan_frequencies( // the first step in Huffman encoding is t
 ) {
     assert(buffer);
 
+#if !HUFFMAN_PQUEUE_LAZY
     memset(buffer, 0U, sizeof(btnode_t) * node_count); // zero out the binary tree node buffer
+#endif
     pqueue_t prqueue = { .count = 0, .capacity = (unsigned) node_count, .tree = buffer };
     // (pqueue_t) { .tree = buffer, .count = 0, .capacity = node_count }; this syntax is invalid in C++, yikes!
     return prqueue;
@@ -113,7 +282,9 @@ static inline void  scan_frequencies( // the first step in Huffman encoding is t
 
 static inline void pqueue_clean(pqueue_t* const restrict prqueue) {
     assert(prqueue);
+#if !HUFFMAN_PQUEUE_LAZY
     memset(prqueue->tree, 0U, sizeof(btnode_t) * prqueue->capacity); // cleanup the buffer
+#endif
     memset(prqueue, 0U, sizeof(pqueue_t));
 }
 
@@ -167,7 +338,9 @@ static inline bool pqueue_pop(pqueue_t* const restrict prqueue, btnode_t* const
     btnode_t           _temp          = { 0 };
     *popped                           = prqueue->tree[0];
     prqueue->tree[0]                  = prqueue->tree[prqueue->count - 1];
+#if !HUFFMAN_PQUEUE_LAZY
     prqueue->tree[prqueue->count - 1] = _placeholder;
+#endif
     prqueue->count--;
 
     while (true) {
@@ -190,13 +363,229 @@ static inline btnode_t pqueue_peek(const pqueue_t* const restrict prqueue) {
     assert(prqueue);
 
     const btnode_t _placeholder = { 0 };
-    return prqueue->tree ? prqueue->tree[0] : _placeholder;
+    return prqueue->count ? prqueue->tree[0] : _placeholder; // the slots past count may hold stale nodes
+}
+
+// moves the hole at pos down to where node belongs and puts node there
+static inline void pqueue_sift_down(pqueue_t* const restrict prqueue, unsigned long long pos, const btnode_t node) {
+    unsigned long long _leftchildpos = 0, _rightchildpos = 0, _pos = 0; // NOLINT(readability-isolate-declaration)
+
+    while ((_leftchildpos = lchild_position(pos)) < prqueue->count) {
+        _rightchildpos = rchild_position(pos);
+        _pos = (_rightchildpos < prqueue->count) && compare(prqueue->tree[_rightchildpos], prqueue->tree[_leftchildpos]) ? _rightchildpos :
+                                                                                                                             _leftchildpos;
+        if (!compare(prqueue->tree[_pos], node)) break;
+        prqueue->tree[pos] = prqueue->tree[_pos];
+        pos                = _pos;
+    }
+    prqueue->tree[pos] = node;
+}
+
+// restores the heap property over the whole buffer bottom up (Floyd), every parent starting from the last one is sifted down over
+// its subtrees, which are heaps already, O(n) in total instead of the O(n log n) of n pushes
+static inline void pqueue_heapify(pqueue_t* const restrict prqueue) {
+    for (unsigned long long pos = prqueue->count / 2; pos-- > 0;) pqueue_sift_down(prqueue, pos, prqueue->tree[pos]);
+}
+
+// makes a priority queue of the count nodes the caller has already written to the front of the buffer, without moving them elsewhere
+[[nodiscard]] static inline pqueue_t pqueue_from_array(
+    btnode_t* const restrict buffer, const unsigned long long node_count, const unsigned long long count /* nodes in the buffer */
+) {
+    assert(buffer);
+    assert(count <= node_count);
+
+#if !HUFFMAN_PQUEUE_LAZY
+    memset(buffer + count, 0U, sizeof(btnode_t) * (node_count - count)); // the rest of the buffer is zeroed, as pqueue_init() does
+#endif
+    pqueue_t prqueue = { .count = (unsigned) count, .capacity = (unsigned) node_count, .tree = buffer };
+    pqueue_heapify(&prqueue);
+    return prqueue;
+}
+
+// gives up the node at the top and puts data in its place with a single sift down, where a pqueue_pop() followed by a pqueue_push()
+// would sift down and then up again, unlike pqueue_pop() this never cleans the queue
+static inline bool pqueue_replace_top(pqueue_t* const restrict prqueue, const btnode_t data, btnode_t* const restrict popped) {
+    assert(prqueue);
+    assert(popped);
+
+    if (!prqueue->count) [[unlikely]]
+        return false;
+
+    *popped = prqueue->tree[0];
+    pqueue_sift_down(prqueue, 0, data);
+    return true;
+}
+
+// pushes data then pops the top, when data would be the new top it comes straight back without the heap being touched
+static inline void pqueue_pushpop(pqueue_t* const restrict prqueue, const btnode_t data, btnode_t* const restrict popped) {
+    assert(prqueue);
+    assert(popped);
+
+    if (!prqueue->count || !compare(prqueue->tree[0], data)) {
+        *popped = data;
+        return;
+    }
+
+    *popped = prqueue->tree[0];
+    pqueue_sift_down(prqueue, 0, data);
+}
+
+// appends count nodes and restores the heap, a batch at least as large as the queue is heapified, a smaller one pushed node by node
+static inline bool pqueue_push_bulk(
+    pqueue_t* const restrict prqueue, const btnode_t* const restrict nodes, const unsigned long long count
+) {
+    assert(prqueue);
+    assert(nodes || !count);
+
+    if (prqueue->count + count > prqueue->capacity) [[unlikely]] {
+        fprintf(stderr, "Error:: %s failed because there's no more space in the pqueue_t buffer\n", __PRETTY_FUNCTION__);
+        return false;
+    }
+    if (!count) return true; // nodes may be a nullptr then
+
+    if (count < prqueue->count) {
+        for (unsigned long long i = 0; i < count; ++i) pqueue_push(prqueue, nodes[i]);
+        return true;
+    }
+
+    memcpy(prqueue->tree + prqueue->count, nodes, sizeof(btnode_t) * count);
+    prqueue->count += (unsigned) count;
+    pqueue_heapify(prqueue);
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------//
+//                               A D-ARY VARIANT OF THE PRIORITY QUEUE WITH CACHE LINE SIZED SIBLINGS                            //
+//-------------------------------------------------------------------------------------------------------------------------------//
+
+// a binary heap of n nodes is log2(n) levels deep and every level of a sift down touches a different cache line, with d children per
+// node the heap is only log_d(n) levels deep and the d children compared at each level are adjacent, so a level costs one cache line
+// the buffer should be 64 byte aligned for the groups of siblings to not straddle cache lines, node_count includes the
+// HUFFMAN_PQUEUE_ARITY - 1 slots skipped at the front
+// sifts move a hole instead of swapping nodes, and unlike pqueue_t nothing is zeroed, neither here nor when the queue runs dry
+
+[[nodiscard]] static inline dpqueue_t dpqueue_init(btnode_t* const restrict buffer, const unsigned long long node_count) {
+    assert(buffer);
+    assert(node_count >= HUFFMAN_PQUEUE_ARITY);
+
+    dpqueue_t prqueue = { .count    = 0,
+                          .capacity = (unsigned) (node_count - HUFFMAN_PQUEUE_ARITY + 1),
+                          .tree     = buffer + HUFFMAN_PQUEUE_ARITY - 1 };
+    return prqueue;
+}
+
+static inline void dpqueue_clean(dpqueue_t* const restrict prqueue) {
+    assert(prqueue);
+    memset(prqueue, 0U, sizeof(dpqueue_t));
+}
+
+static inline bool dpqueue_push(dpqueue_t* const restrict prqueue, const btnode_t data) {
+    assert(prqueue);
+
+    unsigned long long _childpos = prqueue->count, _parentpos = 0; // NOLINT(readability-isolate-declaration)
+
+    if (prqueue->count + 1 > prqueue->capacity) [[unlikely]] {
+        fprintf(stderr, "Error:: %s failed because there's no more space in the dpqueue_t buffer\n", __PRETTY_FUNCTION__);
+        return false;
+    }
+
+    prqueue->count++;
+    while (_childpos > 0) {
+        _parentpos = (_childpos - 1) / HUFFMAN_PQUEUE_ARITY;
+        if (!compare(data, prqueue->tree[_parentpos])) break;
+        prqueue->tree[_childpos] = prqueue->tree[_parentpos]; // pull the parent down into the hole
+        _childpos                = _parentpos;
+    }
+    prqueue->tree[_childpos] = data;
+
+    return true;
+}
+
+// moves the node into the hole at the root and sifts it down to where it belongs
+static inline void dpqueue_sift_down(dpqueue_t* const restrict prqueue, const btnode_t node) {
+    unsigned long long _parentpos = 0, _firstchild = 0, _pos = 0; // NOLINT(readability-isolate-declaration)
+
+    while ((_firstchild = _parentpos * HUFFMAN_PQUEUE_ARITY + 1) < prqueue->count) {
+        _pos = _firstchild;
+        if (_firstchild + HUFFMAN_PQUEUE_ARITY <= prqueue->count) [[likely]] { // all the siblings are there, no bounds checks needed
+            for (unsigned c = 1; c < HUFFMAN_PQUEUE_ARITY; ++c)
+                _pos = compare(prqueue->tree[_firstchild + c], prqueue->tree[_pos]) ? _firstchild + c : _pos;
+        } else {
+            for (unsigned long long c = _firstchild + 1; c < prqueue->count; ++c)
+                _pos = compare(prqueue->tree[c], prqueue->tree[_pos]) ? c : _pos;
+        }
+
+        if (!compare(prqueue->tree[_pos], node)) break;
+        prqueue->tree[_parentpos] = prqueue->tree[_pos]; // pull the smallest child up into the hole
+        _parentpos                = _pos;
+    }
+    prqueue->tree[_parentpos] = node;
+}
+
+static inline bool dpqueue_pop(dpqueue_t* const restrict prqueue, btnode_t* const restrict popped) {
+    assert(prqueue);
+    assert(popped);
+
+    const btnode_t _placeholder = {};
+
+    if (!prqueue->count) {
+        *popped = _placeholder;
+        return false;
+    }
+
+    *popped = prqueue->tree[0];
+    prqueue->count--;
+    if (prqueue->count) dpqueue_sift_down(prqueue, prqueue->tree[prqueue->count]);
+    return true;
+}
+
+static inline bool dpqueue_replace_top(dpqueue_t* const restrict prqueue, const btnode_t data, btnode_t* const restrict popped) {
+    assert(prqueue);
+    assert(popped);
+
+    if (!prqueue->count) [[unlikely]]
+        return false;
+
+    *popped = prqueue->tree[0];
+    dpqueue_sift_down(prqueue, data);
+    return true;
+}
+
+static inline void dpqueue_pushpop(dpqueue_t* const restrict prqueue, const btnode_t data, btnode_t* const restrict popped) {
+    assert(prqueue);
+    assert(popped);
+
+    if (!prqueue->count || !compare(prqueue->tree[0], data)) {
+        *popped = data;
+        return;
+    }
+
+    *popped = prqueue->tree[0];
+    dpqueue_sift_down(prqueue, data);
+}
+
+static inline btnode_t dpqueue_peek(const dpqueue_t* const restrict prqueue) {
+    assert(prqueue);
+
+    const btnode_t _placeholder = {};
+    return prqueue->count ? prqueue->tree[0] : _placeholder;
 }
 
 //-------------------------------------------------------------------------------------------------------------------------------//
 //                                          ROUTINES FOR HUFFMAN TREE BUILDING                                                   //
 //-------------------------------------------------------------------------------------------------------------------------------//
 
+// btnode_t counts in 32 bits, which every tree compress() builds fits in, but a tree over a whole file of 4 GiBs or more does not
+[[nodiscard]] static inline bool are_frequencies_representable(const unsigned long long* const restrict frequencies) {
+    unsigned long long total = 0;
+    for (unsigned i = 0; i < BYTECOUNT; ++i) total += frequencies[i];
+    if (total > UINT32_MAX) [[unlikely]] {
+        fprintf(stderr, "Error in %s at line %d:: %s was given %llu symbols, more than btnode_t can count\n", __FILE__, __LINE__, __FUNCTION__, total);
+        return false;
+    }
+    return true;
+}
+
 static inline bntree_t build_huffman_tree(
     const unsigned long long* const restrict frequencies,
     btnode_t* const restrict pqueue_nodebuffer,
@@ -206,68 +595,436 @@ static inline bntree_t build_huffman_tree(
     assert(pqueue_nodebuffer);
     assert(bntree_nodebuffer);
 
-    pqueue_t           prqueue = pqueue_init(pqueue_nodebuffer, GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+    bntree_t huffman = { 0 }; // Huffman tree
+    if (!are_frequencies_representable(frequencies)) [[unlikely]]
+        return huffman;
+
     btnode_t           temp = { 0 }, aggregate = { 0 };
-    bntree_t           huffman                         = { 0 }; // Huffman tree
     unsigned long long nsymbols_with_nonzero_frequency = 0, write_caret = 0;
 
-    // first push all the leaf nodes into the priority queue
+    // first lay all the leaf nodes out in the priority queue's buffer, then heapify them in one go
     for (unsigned i = 0; i < BYTECOUNT; ++i) {
         if (frequencies[i]) { // only entertain the bytes with non zero frequencies
-            temp.left = temp.right = NULL;
-            temp.data.symbol       = i;
-            temp.data.frequency    = frequencies[i];
+            temp.left      = 0;
+            temp.symbol    = (unsigned short) i;
+            temp.frequency = (unsigned) frequencies[i];
 
-            if (!pqueue_push(&prqueue, temp)) [[unlikely]] {
-                // TODO
-            }
-            nsymbols_with_nonzero_frequency++; // register the number of bytes with non-zero frequencies
+            pqueue_nodebuffer[nsymbols_with_nonzero_frequency++] = temp; // register the number of bytes with non-zero frequencies
         }
     }
+    pqueue_t prqueue = pqueue_from_array(pqueue_nodebuffer, GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY, nsymbols_with_nonzero_frequency);
 
     dbgprinf("There were %4llu unique symbols in this buffer\n", nsymbols_with_nonzero_frequency);
-    temp.data.symbol = temp.data.frequency = 0; // .left and .right are already set to NULL
+    temp.symbol = temp.frequency = 0; // .left is already set to 0
 
     // bootstrap the binary tree
     huffman.tree                           = bntree_nodebuffer; // take ownership of the buffer
 
     // now to the actual Huffman tree building
-    while (pqueue_pop(&prqueue, &temp) // || pqueue_pop(&prqueue, &popped_02)
-           // when the first call returns true the programme never evaluates the second call, FUCKING SHORTCIRCUITING HEH :(
-    ) { // while the priority queue is not empty, take nodes one by one and start building the Huffman tree
-        dbgprinf("%10llX - %10llu\n", temp.data.symbol, temp.data.frequency);
-
-        // when the priority queue is empty, pqueue_pop() will update the popped struct to be an empty struct so we do not need to
-        // do that at the end of the loop manually
+    // pqueue_pop() cleans up the priority queue when it gives up the last node, so the aggregate of the last two nodes cannot be
+    // pushed back into the queue, that aggregate is the root of the Huffman tree and goes straight into the tree's buffer
+    while (prqueue.count > 1) {
+        pqueue_pop(&prqueue, &temp);
+        dbgprinf("%10hX - %10u\n", temp.symbol, temp.frequency);
 
         huffman.tree[write_caret++] = temp; // copy the popped node to the tree's buffer
         huffman.node_count++;               // document the copy
 
-        // pop another node to pair with the previous node
-        if (!pqueue_pop(&prqueue, &temp)) break;
+        // the node to pair with the previous node is now at the top, the aggregate takes its place there once it is made
+        temp = pqueue_peek(&prqueue);
+        dbgprinf("%10hX - %10u\n", temp.symbol, temp.frequency);
 
-        dbgprinf("%10llX - %10llu\n", temp.data.symbol, temp.data.frequency);
-
-        huffman.tree[write_caret++] = temp; // copy the popped node to the tree's buffer
+        huffman.tree[write_caret++] = temp; // copy the node at the top to the tree's buffer
         huffman.node_count++;               // document the copy
 
         // make the third node, with the combined frequency of the two popped nodes
-        // Huffman tree is left balanced, so the smallest node goes to the left
-        aggregate.left        = huffman.tree + write_caret - 2; // popped first, the smallest
-        aggregate.right       = huffman.tree + write_caret - 1; // popped second, the next smallest
-        aggregate.data.symbol = UINT32_MAX;                     // this a marker that registers that this is not a leaf node
-        aggregate.data.frequency =
-            aggregate.left->data.frequency + aggregate.right->data.frequency; // cumulative frequency of the two child nodes
-
-        if (!pqueue_push(&prqueue, aggregate)) [[unlikely]] { // push the new non-leaf node into the priority queue
-            // TODO
+        // Huffman tree is left balanced, so the smallest node goes to the left, the next smallest right after it
+        aggregate.left      = (unsigned short) (write_caret - 2); // popped first, the smallest
+        aggregate.symbol    = BTNODE_INTERNAL;                    // this a marker that registers that this is not a leaf node
+        aggregate.frequency = huffman.tree[write_caret - 2].frequency + huffman.tree[write_caret - 1].frequency; // cumulative frequency
+
+        if (prqueue.count == 1) { // the priority queue is about to run dry, so this aggregate is the root
+            pqueue_pop(&prqueue, &temp);
+            huffman.tree[write_caret++] = aggregate;
+            huffman.node_count++;
+            break;
         }
+
+        // the aggregate replaces the second node at the top with one sift down, popping that node and pushing the aggregate would
+        // take a sift down and a sift up
+        pqueue_replace_top(&prqueue, aggregate, &temp);
+    }
+
+    if (pqueue_pop(&prqueue, &temp)) { // a buffer with only one unique symbol makes a tree with a lone leaf as the root
+        huffman.tree[write_caret++] = temp;
+        huffman.node_count++;
     }
     dbgprinf("Have appended %8llu nodes to the Huffman tree\n", write_caret);
 
+    // the last node to leave the priority queue is the one that aggregates all the others
+    huffman.root = write_caret ? huffman.tree + write_caret - 1 : nullptr;
     return huffman;
 }
 
+// sorts count keys in ascending order with a least significant digit first radix sort, bytes above the largest key are skipped
+static inline void radix_sort_keys(unsigned long long* const restrict keys, unsigned long long* const restrict scratch, const unsigned count) {
+    assert(keys);
+    assert(scratch);
+
+    unsigned long long largest = 0;
+    unsigned long long *source = keys, *destination = scratch, *swap = nullptr; // NOLINT(readability-isolate-declaration)
+    for (unsigned i = 0; i < count; ++i) largest |= keys[i];
+
+    for (unsigned shift = 0; shift < 64 && (largest >> shift); shift += 8) {
+        unsigned offsets[BYTECOUNT] = { 0 };
+        for (unsigned i = 0; i < count; ++i) offsets[(unsigned char) (source[i] >> shift)]++;
+        for (unsigned i = 0, sum = 0, temp = 0; i < BYTECOUNT; ++i) { // NOLINT(readability-isolate-declaration)
+            temp       = offsets[i];
+            offsets[i] = sum;
+            sum       += temp;
+        }
+        for (unsigned i = 0; i < count; ++i) destination[offsets[(unsigned char) (source[i] >> shift)]++] = source[i];
+
+        swap        = source;
+        source      = destination;
+        destination = swap;
+    }
+
+    if (source != keys) memcpy(keys, source, sizeof(unsigned long long) * count);
+}
+
+// the same tree as build_huffman_tree() in linear time, without a priority queue
+// aggregates are made in non decreasing order of frequency, so once the leaves are sorted, the two smallest nodes are always at the
+// heads of two queues, the sorted leaves and the aggregates in the order they were made. both queues live in one array, the leaves
+// up front and the aggregates right after them, and the pair taken off them is copied next to each other into bntree_nodebuffer,
+// ties go to the leaves, which keeps the tree as shallow as possible
+static inline bntree_t build_huffman_tree_linear(
+    const unsigned long long* const restrict frequencies, btnode_t* const restrict bntree_nodebuffer /* at least 2 * BYTECOUNT - 1 nodes */
+) {
+    assert(frequencies);
+    assert(bntree_nodebuffer);
+
+    bntree_t huffman = {};
+    if (!are_frequencies_representable(frequencies)) [[unlikely]]
+        return huffman;
+
+    unsigned long long keys[BYTECOUNT]       = { 0 }; // frequency in the upper 56 bits, symbol in the lowest 8, so ties sort by symbol
+    unsigned long long scratch[BYTECOUNT]    = { 0 };
+    btnode_t           queues[BYTECOUNT * 2] = {}; // 4 KiBs, the sorted leaves followed by the aggregates
+    unsigned           nleaves = 0, leaf = 0, aggregate = 0, tail = 0; // NOLINT(readability-isolate-declaration)
+
+    for (unsigned i = 0; i < BYTECOUNT; ++i) {
+        if (!frequencies[i]) continue;
+        keys[nleaves++] = (frequencies[i] << 8) | i;
+    }
+    radix_sort_keys(keys, scratch, nleaves);
+
+    for (unsigned i = 0; i < nleaves; ++i) {
+        queues[i].frequency = (unsigned) (keys[i] >> 8);
+        queues[i].symbol    = (unsigned short) (keys[i] & 0xFF);
+    }
+
+    huffman.tree = bntree_nodebuffer;
+    for (aggregate = tail = nleaves; tail + 1 < 2 * nleaves; ++tail) {
+        for (unsigned c = 0; c < 2; ++c) { // take the smaller of the two queue heads, twice
+            if ((leaf < nleaves) && ((aggregate == tail) || (queues[leaf].frequency <= queues[aggregate].frequency)))
+                huffman.tree[huffman.node_count++] = queues[leaf++];
+            else
+                huffman.tree[huffman.node_count++] = queues[aggregate++];
+        }
+
+        queues[tail].left      = (unsigned short) (huffman.node_count - 2);
+        queues[tail].symbol    = BTNODE_INTERNAL;
+        queues[tail].frequency = huffman.tree[huffman.node_count - 2].frequency + huffman.tree[huffman.node_count - 1].frequency;
+    }
+
+    // whatever is left in the queues is the root, the last aggregate or a lone leaf
+    if (nleaves) huffman.tree[huffman.node_count++] = queues[tail - 1];
+    huffman.root = huffman.node_count ? huffman.tree + huffman.node_count - 1 : nullptr;
+    return huffman;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------//
+//                                          ROUTINES FOR HUFFMAN CODE GENERATION                                                 //
+//-------------------------------------------------------------------------------------------------------------------------------//
+
+// walks the Huffman tree from the root to every leaf, registering the depth of the leaf as the code length of its symbol
+// returns false if the tree has leaves deeper than HUFFMAN_MAX_CODE_LENGTH, in which case the lengths are unusable
+static inline bool build_code_lengths(const bntree_t* const restrict huffman, unsigned char* const restrict lengths /* BYTECOUNT entries */) {
+    assert(huffman);
+    assert(lengths);
+
+    struct {
+            const btnode_t* node;
+            unsigned        length;
+    } stack[BYTECOUNT] = {}; // a path can only hold as many nodes as there are leaves in the tree, hence the depth is bounded
+    unsigned top = 0;
+
+    memset(lengths, 0U, sizeof(unsigned char) * BYTECOUNT);
+    if (!huffman->root) return true; // an empty tree has no codes to speak of
+
+    // when the buffer had only one unique symbol, the root is a leaf and would get a zero length code
+    if (huffman->root->symbol != BTNODE_INTERNAL) {
+        lengths[huffman->root->symbol] = 1;
+        return true;
+    }
+
+    stack[top++].node = huffman->root; // length of the root is 0
+
+    while (top) {
+        const btnode_t* const node   = stack[--top].node;
+        const unsigned        length = stack[top].length;
+
+        if (node->symbol != BTNODE_INTERNAL) { // Huffman trees are full binary trees, nodes are either leaves or have both arms
+            if (length > HUFFMAN_MAX_CODE_LENGTH) [[unlikely]] {
+                dbgprinf("Symbol %4hu needs a %u bit code, which does not fit in hcode_t\n", node->symbol, length);
+                return false;
+            }
+            lengths[node->symbol] = (unsigned char) length;
+            continue;
+        }
+
+        stack[top].node     = huffman->tree + node->left + 1; // the right child
+        stack[top++].length = length + 1;
+        stack[top].node     = huffman->tree + node->left;
+        stack[top++].length = length + 1;
+    }
+
+    return true;
+}
+
+// rewrites count frequencies sorted in ascending order into the code lengths of a Huffman code for them, in place, with O(1) extra space
+// (Moffat & Katajainen, 1995, "In-place calculation of minimum-redundancy codes"), the lengths come out in non increasing order
+// the first pass runs the two queue merge of build_huffman_tree_linear() inside the array, leaving the aggregates' weights to the left
+// and overwriting consumed aggregates with the index of their parent, the second pass turns the parent indices into depths, and the
+// third hands out as many leaves at each depth as the internal nodes one level up have room for
+static inline void minimum_redundancy_lengths(unsigned long long* const restrict array, const unsigned long long count) {
+    assert(array || !count);
+
+    unsigned long long root = 0, leaf = 2, next = 0, available = 1, used = 0, depth = 0; // NOLINT(readability-isolate-declaration)
+
+    if (count < 2) { // a lone symbol still needs a 1 bit code
+        if (count) array[0] = 1;
+        return;
+    }
+
+    array[0] += array[1];
+    for (next = 1; next < count - 1; ++next) {
+        // the first of the pair, ties go to the leaves
+        if ((leaf >= count) || (array[root] < array[leaf])) {
+            array[next]   = array[root];
+            array[root++] = next;
+        } else
+            array[next] = array[leaf++];
+
+        // the second of the pair
+        if ((leaf >= count) || ((root < next) && (array[root] < array[leaf]))) {
+            array[next]   += array[root];
+            array[root++]  = next;
+        } else
+            array[next] += array[leaf++];
+    }
+
+    array[count - 2] = 0; // the root is at depth 0, every other aggregate is one deeper than its parent
+    for (next = count - 2; next-- > 0;) array[next] = array[array[next]] + 1;
+
+    root = count - 2;
+    next = count - 1;
+    while (available) {
+        while ((root < count) && (array[root] == depth)) { // root wraps around past 0 once the aggregates run out
+            used++;
+            root--;
+        }
+        while (available > used) {
+            array[next--] = depth;
+            available--;
+        }
+        available = 2 * used;
+        depth++;
+        used = 0;
+    }
+}
+
+// code lengths of a Huffman code straight from the frequencies, without building a tree, the whole working set is the sorted keys,
+// the radix sort's scratch and the symbols, a little over 4 KiBs instead of the 32 KiBs of btnode_t s a tree takes
+// returns false if some code is longer than HUFFMAN_MAX_CODE_LENGTH, in which case the lengths are unusable
+static inline bool build_code_lengths_inplace(
+    const unsigned long long* const restrict frequencies, unsigned char* const restrict lengths /* BYTECOUNT entries */
+) {
+    assert(frequencies);
+    assert(lengths);
+
+    unsigned long long keys[BYTECOUNT]    = { 0 }; // frequency in the upper 56 bits, symbol in the lowest 8, so ties sort by symbol
+    unsigned long long scratch[BYTECOUNT] = { 0 };
+    unsigned char      symbols[BYTECOUNT] = { 0 };
+    unsigned           nleaves            = 0;
+    bool               is_fit             = true;
+
+    for (unsigned i = 0; i < BYTECOUNT; ++i) {
+        if (!frequencies[i]) continue;
+        assert(frequencies[i] < (1LLU << 56));
+        keys[nleaves++] = (frequencies[i] << 8) | i;
+    }
+    radix_sort_keys(keys, scratch, nleaves);
+
+    for (unsigned i = 0; i < nleaves; ++i) {
+        symbols[i]   = (unsigned char) keys[i];
+        keys[i]    >>= 8;
+    }
+    minimum_redundancy_lengths(keys, nleaves);
+
+    memset(lengths, 0U, sizeof(unsigned char) * BYTECOUNT);
+    for (unsigned i = 0; i < nleaves; ++i) {
+        is_fit              &= keys[i] <= HUFFMAN_MAX_CODE_LENGTH;
+        lengths[symbols[i]]  = (unsigned char) keys[i];
+    }
+    return is_fit;
+}
+
+// a canonical Huffman code is fully determined by its code lengths, codes are handed out in the increasing order of (length, symbol)
+// each code being the previous code plus one, appended with 0s when moving on to a longer length
+// e.g. lengths A = 3, B = 3, C = 3, D = 3, E = 3, F = 2, G = 4, H = 4 make the codes
+// F = 00, A = 010, B = 011, C = 100, D = 101, E = 110, G = 1110, H = 1111
+// so the code table can be shipped as BYTECOUNT lengths instead of a tree, and rebuilt without ever materializing a btnode_t
+// returns false if the lengths are too long or oversubscribe the code space, i.e. they cannot make a prefix free code
+static inline bool build_canonical_codes(const unsigned char* const restrict lengths, hcode_t* const restrict codes /* BYTECOUNT entries */) {
+    assert(lengths);
+    assert(codes);
+
+    unsigned count[HUFFMAN_MAX_CODE_LENGTH + 1] = { 0 }; // number of codes of each length
+    unsigned next[HUFFMAN_MAX_CODE_LENGTH + 1]  = { 0 }; // the next code to hand out for each length
+    unsigned code                               = 0;
+
+    for (unsigned i = 0; i < BYTECOUNT; ++i) {
+        if (lengths[i] > HUFFMAN_MAX_CODE_LENGTH) [[unlikely]]
+            return false;
+        count[lengths[i]]++;
+    }
+
+    for (unsigned length = 1; length <= HUFFMAN_MAX_CODE_LENGTH; ++length) {
+        code         = (code + count[length - 1] * (length > 1)) << 1; // the first code of this length, count[0] holds the unused symbols
+        next[length] = code;
+        if (code + count[length] > (1U << length)) [[unlikely]]
+            return false; // more codes of this length than the code space has room for
+    }
+
+    for (unsigned i = 0; i < BYTECOUNT; ++i) {
+        codes[i].is_used = lengths[i] != 0;
+        codes[i].length  = lengths[i];
+        codes[i].code    = lengths[i] ? (unsigned short) next[lengths[i]]++ : 0;
+    }
+
+    return true;
+}
+
+// a leaf in the package-merge lists
+typedef struct _pmleaf {
+        unsigned long long frequency;
+        unsigned           symbol;
+} pmleaf_t;
+
+[[nodiscard]] static inline int pmleaf_compare(const void* const left, const void* const right) { // ascending frequency, then symbol
+    const pmleaf_t* const _left  = (const pmleaf_t*) left;
+    const pmleaf_t* const _right = (const pmleaf_t*) right;
+    if (_left->frequency != _right->frequency) return _left->frequency < _right->frequency ? -1 : 1;
+    return (int) _left->symbol - (int) _right->symbol;
+}
+
+// computes optimal code lengths under the constraint that no code is longer than maxlength bits, using package-merge
+// (Larmore & Hirschberg, 1990), this is what keeps skewed histograms from producing codes that do not fit in hcode_t
+//
+// picture every symbol as a coin worth 2^-l for each of the levels l = 1 .. maxlength, with its frequency as the coin's numismatic value
+// starting at the deepest level, pair up the cheapest items of a level into packages, and merge those packages with the level above's
+// leaves, the 2n - 2 cheapest items of the topmost list make up the cheapest collection of coins worth n - 1, the code length of a
+// symbol is the number of levels its coins were picked from, either directly or inside a package
+//
+// since leaves show up in every list in the same sorted order, the picked leaves of a level are always a prefix of the sorted leaves
+// so walking back down the levels, counting the leaves and packages amongst the picked items, is enough to recover the lengths
+// returns false if maxlength is too short to give every used symbol a distinct code
+static inline bool build_limited_code_lengths(
+    const unsigned long long* const restrict frequencies, const unsigned maxlength, unsigned char* const restrict lengths /* BYTECOUNT entries */
+) {
+    assert(frequencies);
+    assert(lengths);
+    assert(maxlength <= HUFFMAN_MAX_CODE_LENGTH);
+
+    pmleaf_t           leaves[BYTECOUNT]                                 = {};
+    unsigned long long weights[2][BYTECOUNT * 2]                         = { 0 }; // weights of the previous and the current list
+    bool               is_package[HUFFMAN_MAX_CODE_LENGTH][BYTECOUNT * 2] = { 0 }; // the makeup of every list, for walking back
+    unsigned           nleaves = 0, previous = 0, count = 0; // NOLINT(readability-isolate-declaration)
+
+    memset(lengths, 0U, sizeof(unsigned char) * BYTECOUNT);
+    for (unsigned i = 0; i < BYTECOUNT; ++i) {
+        if (!frequencies[i]) continue;
+        leaves[nleaves].frequency  = frequencies[i];
+        leaves[nleaves++].symbol   = i;
+    }
+
+    if (!nleaves) return true;
+    if (nleaves == 1) { // a lone symbol still needs a one bit code
+        lengths[leaves[0].symbol] = 1;
+        return true;
+    }
+    if (!maxlength || (1LLU << maxlength) < nleaves) [[unlikely]]
+        return false;
+
+    qsort(leaves, nleaves, sizeof(pmleaf_t), pmleaf_compare);
+
+    // the deepest list has nothing but leaves
+    for (unsigned i = 0; i < nleaves; ++i) weights[0][i] = leaves[i].frequency;
+    previous = nleaves;
+
+    for (unsigned level = 1; level < maxlength; ++level) {
+        const unsigned long long* const restrict below   = weights[(level - 1) % 2];
+        unsigned long long* const restrict       current = weights[level % 2];
+        const unsigned                           npackages = previous / 2; // an unpaired item at the tail is left behind
+        unsigned                                 leaf = 0, package = 0;    // NOLINT(readability-isolate-declaration)
+
+        count = 0;
+        while (leaf < nleaves || package < npackages) { // merge the leaves with the packages, leaves win the ties
+            const unsigned long long packaged = package < npackages ? below[2 * package] + below[2 * package + 1] : 0;
+            if (package >= npackages || (leaf < nleaves && leaves[leaf].frequency <= packaged)) {
+                current[count]             = leaves[leaf++].frequency;
+                is_package[level][count++] = false;
+            } else {
+                current[count]             = packaged;
+                is_package[level][count++] = true;
+                package++;
+            }
+        }
+        previous = count;
+    }
+
+    // walk back down the lists, starting with the 2n - 2 cheapest items of the topmost list
+    count = 2 * nleaves - 2;
+    for (unsigned level = maxlength; level-- > 0;) {
+        unsigned npackages = 0;
+        for (unsigned i = 0; i < count; ++i) npackages += level ? is_package[level][i] : 0;
+        for (unsigned i = 0; i < count - npackages; ++i) lengths[leaves[i].symbol]++; // the cheapest leaves got picked at this level
+        count = 2 * npackages;
+    }
+
+    return true;
+}
+
+// builds the canonical code table for the leaves of the Huffman tree, returns false if the tree is too deep for hcode_t
+static inline bool build_code_table(const bntree_t* const restrict huffman, hcode_t* const restrict codes /* BYTECOUNT entries */) {
+    assert(huffman);
+    assert(codes);
+
+    unsigned char lengths[BYTECOUNT] = { 0 };
+    return build_code_lengths(huffman, lengths) && build_canonical_codes(lengths, codes);
+}
+
+// total number of bits needed to encode a buffer with the given symbol frequencies using the given code table
+[[nodiscard]] static inline unsigned long long encoded_bit_count(
+    const unsigned long long* const restrict frequencies, const hcode_t* const restrict codes
+) {
+    unsigned long long nbits = 0;
+    for (unsigned i = 0; i < BYTECOUNT; ++i) nbits += frequencies[i] * codes[i].length;
+    return nbits;
+}
+
 // the goal of Huffman encoding is to represent symbols that occur more frequently with fewer bits than the symbols that occur less
 // frequently - a concept known as minimum entropy coding
 // the "symbol" here can be anything but is usually a byte!
@@ -285,14 +1042,528 @@ static inline bntree_t build_huffman_tree(
 // = 14.2646625064904
 // again, in theory all the 'C' characters in the above string can be represented by a total of 14.2646625064904 bits
 
+//-------------------------------------------------------------------------------------------------------------------------------//
+//                                                  ROUTINES FOR ENCODING                                                        //
+//-------------------------------------------------------------------------------------------------------------------------------//
+
+// compressed stream layout, all multibyte header fields are stored in the host's byte order
+//
+//  [unsigned long long] number of bytes in the uncompressed buffer
+//  followed by one record per HUFFMAN_BLOCK_SIZE bytes of input (the last block may be shorter)
+//      [unsigned char]  block_kind
+//      BLOCK_STORED  : the raw bytes of the block
+//      BLOCK_HUFFMAN : [unsigned char x BYTECOUNT] code lengths of the canonical code, [unsigned] number of bytes in the bitstream,
+//                      the bitstream
+//      BLOCK_HUFFMAN_X4 : [unsigned char x BYTECOUNT] code lengths of the canonical code, [unsigned x 4] jump table with the number
+//                      of bytes in each bitstream, the four bitstreams back to back. the block is cut into four segments of
+//                      (blocksize + 3) / 4 symbols, the last one taking whatever is left, and each segment is encoded into its own
+//                      bitstream with the shared code table. this breaks the serial dependency of one lookup on the length resolved
+//                      by the previous, so the decoder can keep four independent lookup chains in flight
+//
+// bitstreams are written MSB first, i.e. the first code of a block begins at bit offset 0 as defined in <bitops.h>
+// and the last byte of a bitstream is padded with 0 bits
+
+typedef enum _block_kind { BLOCK_STORED = 0x00, BLOCK_HUFFMAN = 0x01, BLOCK_HUFFMAN_X4 = 0x02 } block_kind;
+
+// worst case size of the compressed stream, callers must provide an outbuffer of at least this many bytes to compress()
+[[nodiscard]] static inline unsigned long long compress_bound(const unsigned long long size) {
+    return sizeof(unsigned long long) /* stream header */ + (size + HUFFMAN_BLOCK_SIZE - 1) / HUFFMAN_BLOCK_SIZE /* block kinds */
+         + size /* a block is stored raw whenever encoding does not pay off */ + sizeof(unsigned long long) /* slack for the last flush */;
+}
+
+// encodes the buffer with the given code table into outbuffer, returns the number of bytes in the bitstream
+// codes are appended to the bitwriter_t's accumulator HUFFMAN_SYMBOLS_PER_FLUSH codes at a time, after which all the complete
+// bytes in the accumulator are written out with one unaligned store, hence outbuffer needs 8 bytes of slack past the bitstream
+static inline unsigned long long encode_block(
+    const unsigned char* const restrict inbuffer,
+    const unsigned long long size,
+    const hcode_t* const restrict codes,
+    unsigned char* const restrict outbuffer
+) {
+    assert(inbuffer);
+    assert(codes);
+    assert(outbuffer);
+
+    bitwriter_t        writer = {};
+    unsigned long long i      = 0;
+    bitwriter_init(&writer, outbuffer);
+
+    for (; i + HUFFMAN_SYMBOLS_PER_FLUSH <= size; i += HUFFMAN_SYMBOLS_PER_FLUSH) {
+        for (unsigned j = 0; j < HUFFMAN_SYMBOLS_PER_FLUSH; ++j) { // a compile time trip count, the compiler will unroll this
+            const hcode_t hcode = codes[inbuffer[i + j]];
+            append_bits(&writer, hcode.length, hcode.code);
+        }
+        bitwriter_flush(&writer); // branchless flush of all the complete bytes
+    }
+
+    for (; i < size; ++i) { // the tail that didn't make a full round
+        const hcode_t hcode = codes[inbuffer[i]];
+        put_bits(&writer, hcode.length, hcode.code);
+    }
+
+    return bitwriter_finish(&writer); // the trailing partial byte, if any
+}
+
+// compresses the buffer block by block, returns the number of bytes written to outbuffer which must be at least compress_bound(size) bytes
+// with interleaved set, Huffman blocks are written as BLOCK_HUFFMAN_X4 instead of BLOCK_HUFFMAN
+static inline unsigned long long compress_blocks(
+    const unsigned char* const restrict inbuffer, unsigned char* const restrict outbuffer, const unsigned long long size, const bool interleaved
+) {
+    assert(inbuffer || !size); // empty buffers may come without storage
+    assert(outbuffer);
+
+    unsigned long long frequencies[BYTECOUNT] = { 0 };
+    unsigned char      lengths[BYTECOUNT]     = { 0 };
+    hcode_t            codes[BYTECOUNT]       = {};
+    unsigned char*     caret                  = outbuffer;
+    unsigned long long blocksize = 0, nbits = 0, nbytes = 0, segsize = 0; // NOLINT(readability-isolate-declaration)
+    unsigned           nbytes32 = 0, jumptable[4] = { 0 };                 // NOLINT(readability-isolate-declaration)
+
+    memcpy(caret, &size, sizeof(unsigned long long)); // stream header
+    caret += sizeof(unsigned long long);
+
+    for (unsigned long long offset = 0; offset < size; offset += blocksize) {
+        blocksize = (size - offset) < HUFFMAN_BLOCK_SIZE ? (size - offset) : HUFFMAN_BLOCK_SIZE;
+
+        scan_frequencies(inbuffer + offset, blocksize, frequencies);
+
+        // codes longer than HUFFMAN_MAX_CODE_LENGTH are rare enough that computing them first is cheaper than limiting every block
+        if ((build_code_lengths_inplace(frequencies, lengths) ||
+             build_limited_code_lengths(frequencies, HUFFMAN_MAX_CODE_LENGTH, lengths)) &&
+            build_canonical_codes(lengths, codes)) [[likely]] {
+            nbits  = encoded_bit_count(frequencies, codes);
+            nbytes = (nbits + 7) / 8;
+
+            // four bitstreams can take up to three more bytes of padding than one
+            if (interleaved && (sizeof(lengths) + sizeof(jumptable) + nbytes + 3 < blocksize)) {
+                segsize  = (blocksize + 3) / 4; // blocks this large always leave something for the last segment
+                *caret++ = BLOCK_HUFFMAN_X4;
+                memcpy(caret, lengths, sizeof(lengths));
+                caret += sizeof(lengths) + sizeof(jumptable); // the jump table gets filled in once the bitstreams are written
+                for (unsigned k = 0; k < 4; ++k) {
+                    jumptable[k] = (unsigned) encode_block(
+                        inbuffer + offset + k * segsize, k < 3 ? segsize : blocksize - 3 * segsize, codes, caret
+                    );
+                    caret += jumptable[k];
+                }
+                memcpy(caret - jumptable[0] - jumptable[1] - jumptable[2] - jumptable[3] - sizeof(jumptable), jumptable, sizeof(jumptable));
+                continue;
+            }
+
+            if (sizeof(lengths) + sizeof(unsigned) + nbytes < blocksize) { // encode only if it pays off
+                *caret++ = BLOCK_HUFFMAN;
+                memcpy(caret, lengths, sizeof(lengths));
+                caret += sizeof(lengths);
+                nbytes32 = (unsigned) nbytes; // nbytes < blocksize, so this fits in an unsigned
+                memcpy(caret, &nbytes32, sizeof(unsigned));
+                caret += sizeof(unsigned);
+                caret += encode_block(inbuffer + offset, blocksize, codes, caret);
+                continue;
+            }
+        }
+
+        // when the encoded block would be larger than the raw block, store the block as is
+        *caret++ = BLOCK_STORED;
+        memcpy(caret, inbuffer + offset, blocksize);
+        caret += blocksize;
+    }
+
+    return caret - outbuffer;
+}
+
+// compresses the buffer into a single bitstream per block
 static inline unsigned long long compress(
     const unsigned char* const restrict inbuffer, unsigned char* const restrict outbuffer, const unsigned long long size
 ) {
-    //
+    return compress_blocks(inbuffer, outbuffer, size, false);
+}
+
+// compresses the buffer into four interleaved bitstreams per block, trading 12 bytes per block for a much faster decompress()
+static inline unsigned long long compress_interleaved(
+    const unsigned char* const restrict inbuffer, unsigned char* const restrict outbuffer, const unsigned long long size
+) {
+    return compress_blocks(inbuffer, outbuffer, size, true);
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------//
+//                                                  ROUTINES FOR DECODING                                                        //
+//-------------------------------------------------------------------------------------------------------------------------------//
+
+// builds the decode tables for the given code table, a code of up to HUFFMAN_DECODE_TABLE_BITS bits is replicated across all the
+// primary entries that begin with it, so a single lookup with the next HUFFMAN_DECODE_TABLE_BITS bits of the stream resolves both
+// the symbol and its length. codes longer than that share their primary entry with all the codes that have the same prefix, this
+// entry links to a secondary table indexed by the bits that follow the prefix, wide enough for the longest code with that prefix
+static inline bool build_decode_table(const hcode_t* const restrict codes, hdecode_t* const restrict table /* HUFFMAN_DECODE_TABLE_CAPACITY entries */) {
+    assert(codes);
+    assert(table);
+
+    unsigned long long next = 1LLU << HUFFMAN_DECODE_TABLE_BITS; // where the next secondary table begins
+    memset(table, 0U, sizeof(hdecode_t) * HUFFMAN_DECODE_TABLE_CAPACITY);
+
+    for (unsigned i = 0; i < BYTECOUNT; ++i) { // the short codes, and the widths of the secondary tables
+        if (!codes[i].is_used) continue;
+        if (!codes[i].length || codes[i].length > HUFFMAN_MAX_CODE_LENGTH || (codes[i].code >> codes[i].length)) [[unlikely]]
+            return false;
+
+        if (codes[i].length <= HUFFMAN_DECODE_TABLE_BITS) {
+            const unsigned first = (unsigned) codes[i].code << (HUFFMAN_DECODE_TABLE_BITS - codes[i].length);
+            const unsigned count = 1U << (HUFFMAN_DECODE_TABLE_BITS - codes[i].length);
+            for (unsigned j = first; j < first + count; ++j) {
+                if (table[j].length) [[unlikely]]
+                    return false; // the code is not prefix free
+                table[j].value  = (unsigned short) i;
+                table[j].length = codes[i].length;
+            }
+        } else {
+            hdecode_t* const link = table + (codes[i].code >> (codes[i].length - HUFFMAN_DECODE_TABLE_BITS));
+            if (link->subbits < codes[i].length - HUFFMAN_DECODE_TABLE_BITS) link->subbits = codes[i].length - HUFFMAN_DECODE_TABLE_BITS;
+        }
+    }
+
+    for (unsigned i = 0; i < (1U << HUFFMAN_DECODE_TABLE_BITS); ++i) { // lay out the secondary tables
+        if (!table[i].subbits) continue;
+        if (table[i].length || next + (1LLU << table[i].subbits) > HUFFMAN_DECODE_TABLE_CAPACITY) [[unlikely]]
+            return false; // a short code that is a prefix of a long code or an implausibly sparse code, neither can come from a Huffman tree
+        table[i].value  = (unsigned short) next;
+        table[i].length = HUFFMAN_DECODE_TABLE_BITS;
+        next           += 1LLU << table[i].subbits;
+    }
+
+    for (unsigned i = 0; i < BYTECOUNT; ++i) { // the long codes
+        if (!codes[i].is_used || codes[i].length <= HUFFMAN_DECODE_TABLE_BITS) continue;
+
+        const hdecode_t link    = table[codes[i].code >> (codes[i].length - HUFFMAN_DECODE_TABLE_BITS)];
+        const unsigned  sublen  = codes[i].length - HUFFMAN_DECODE_TABLE_BITS;
+        const unsigned  subcode = codes[i].code & ((1U << sublen) - 1);
+        const unsigned  first   = link.value + (subcode << (link.subbits - sublen));
+        const unsigned  count   = 1U << (link.subbits - sublen);
+        for (unsigned j = first; j < first + count; ++j) {
+            if (table[j].length) [[unlikely]]
+                return false;
+            table[j].value  = (unsigned short) i;
+            table[j].length = codes[i].length;
+        }
+    }
+
+    return true;
+}
+
+// resolves the code at the top of the left aligned bits, at most two dependent loads
+[[nodiscard]] static inline hdecode_t __attribute__((__always_inline__)) decode_symbol(
+    const hdecode_t* const restrict table, const unsigned long long bits
+) {
+    const hdecode_t entry = table[bits >> (64 - HUFFMAN_DECODE_TABLE_BITS)];
+    if (!entry.subbits) [[likely]]
+        return entry;
+    return table[entry.value + ((bits << HUFFMAN_DECODE_TABLE_BITS) >> (64 - entry.subbits))];
+}
+
+// decodes size symbols from the reader's position in the bitstream into outbuffer
+// returns false if the symbols need more bits than the bitstream has
+// the reader is taken by value so its fields live in registers, as long as 8 bytes are left in the bitstream, the window is refilled
+// with one unaligned load that always yields at least 57 valid bits, enough for HUFFMAN_SYMBOLS_PER_FLUSH codes
+static inline bool decode_stream(
+    bitreader_t reader, const hdecode_t* const restrict table, unsigned char* const restrict outbuffer, const unsigned long long size
+) {
+    assert(table);
+    assert(outbuffer);
+
+    unsigned long long i     = 0;
+    hdecode_t          entry = {};
+
+    for (; (i + HUFFMAN_SYMBOLS_PER_FLUSH <= size) && bitreader_has_word(&reader); i += HUFFMAN_SYMBOLS_PER_FLUSH) {
+        bitreader_refill_fast(&reader);
+        for (unsigned j = 0; j < HUFFMAN_SYMBOLS_PER_FLUSH; ++j) {
+            entry            = decode_symbol(table, reader.window);
+            outbuffer[i + j] = (unsigned char) entry.value;
+            consume_bits(&reader, entry.length);
+        }
+    }
+
+    for (; i < size; ++i) { // the last few bytes of the bitstream, one symbol per refill
+        if (reader.bitpos / 8 >= reader.nbytes) [[unlikely]]
+            return false;
+        bitreader_refill(&reader);
+        entry        = decode_symbol(table, reader.window);
+        outbuffer[i] = (unsigned char) entry.value;
+        consume_bits(&reader, entry.length);
+    }
+
+    return !bitreader_is_overrun(&reader);
+}
+
+// decodes the four bitstreams of a BLOCK_HUFFMAN_X4 block in lockstep, the four lookup chains do not depend on each other, so
+// the out of order core can overlap their loads instead of waiting on one chain, once the shortest segment runs out or a bitstream
+// gets within 8 bytes of its end, the leftovers of each segment are decoded one bitstream at a time
+static inline bool decode_block_x4(
+    const unsigned char* const restrict bitstreams,
+    const unsigned* const restrict jumptable,
+    const hdecode_t* const restrict table,
+    unsigned char* const restrict outbuffer,
+    const unsigned long long size
+) {
+    assert(bitstreams);
+    assert(jumptable);
+    assert(table);
+    assert(outbuffer);
+    assert(size >= 9); // so the last segment is not negative
+
+    const unsigned long long segsize    = (size + 3) / 4;
+    const unsigned long long lastsize   = size - 3 * segsize; // the shortest segment
+    const unsigned char*     stream     = bitstreams;
+    bitreader_t              readers[4] = {};
+    unsigned long long       i          = 0;
+    hdecode_t                entry      = {};
+
+    for (unsigned k = 0; k < 4; ++k) {
+        bitreader_init(readers + k, stream, jumptable[k]);
+        stream += jumptable[k];
+    }
+
+    for (; (i + HUFFMAN_SYMBOLS_PER_FLUSH <= lastsize) && bitreader_has_word(readers) && bitreader_has_word(readers + 1) &&
+           bitreader_has_word(readers + 2) && bitreader_has_word(readers + 3);
+         i += HUFFMAN_SYMBOLS_PER_FLUSH) {
+        for (unsigned k = 0; k < 4; ++k) bitreader_refill_fast(readers + k);
+        for (unsigned j = 0; j < HUFFMAN_SYMBOLS_PER_FLUSH; ++j) {
+            for (unsigned k = 0; k < 4; ++k) {
+                entry                          = decode_symbol(table, readers[k].window);
+                outbuffer[k * segsize + i + j] = (unsigned char) entry.value;
+                consume_bits(readers + k, entry.length);
+            }
+        }
+    }
+
+    for (unsigned k = 0; k < 4; ++k) {
+        if (!decode_stream(readers[k], table, outbuffer + k * segsize + i, (k < 3 ? segsize : lastsize) - i)) [[unlikely]]
+            return false;
+    }
+    return true;
+}
+
+// builds the multi symbol decode table from the primary entries of a decode table, each index is decoded greedily for as long as
+// the next code is resolved by a primary entry and ends within the index's HUFFMAN_DECODE_TABLE_BITS bits
+// with short codes, like the 3 to 6 bit codes of plain text, a single lookup then resolves 2 or more symbols
+static inline void build_multi_table(const hdecode_t* const restrict table, hmulti_t* const restrict multi /* 1 << HUFFMAN_DECODE_TABLE_BITS entries */) {
+    assert(table);
+    assert(multi);
+
+    for (unsigned i = 0; i < (1U << HUFFMAN_DECODE_TABLE_BITS); ++i) {
+        hmulti_t entry = {};
+
+        while (entry.count < HUFFMAN_MULTI_SYMBOLS) {
+            // the bits past the ones the index has are not known, they are 0s here but only complete codes make it into the entry
+            const hdecode_t next = table[(i << entry.length) & ((1U << HUFFMAN_DECODE_TABLE_BITS) - 1)];
+            if (next.subbits || !next.length || entry.length + next.length > HUFFMAN_DECODE_TABLE_BITS) break;
+            entry.symbols[entry.count++]  = (unsigned char) next.value;
+            entry.length                 += next.length;
+        }
+
+        multi[i] = entry;
+    }
+}
+
+// when the average code length of a block is at most half the width of the decode table, most lookups into the multi symbol table
+// resolve two or more symbols, which more than pays for building it
+[[nodiscard]] static inline bool prefers_multi_table(const unsigned long long nbytes /* bitstream size */, const unsigned long long size /* symbols */) {
+    return 2 * 8 * nbytes <= HUFFMAN_DECODE_TABLE_BITS * size;
+}
+
+// decodes size symbols from the bitstream into outbuffer with the multi symbol table, falling back to the decode table for the
+// lookups whose first code does not fit in the multi symbol table. every lookup writes HUFFMAN_MULTI_SYMBOLS bytes, only
+// count of which are kept, so the unrolled loop stops HUFFMAN_MULTI_SYMBOLS symbols short of every round's worst case
+static inline bool decode_stream_multi(
+    bitreader_t reader,
+    const hdecode_t* const restrict table,
+    const hmulti_t* const restrict multi,
+    unsigned char* const restrict outbuffer,
+    const unsigned long long size
+) {
+    assert(table);
+    assert(multi);
+    assert(outbuffer);
+
+    unsigned long long i      = 0;
+    hdecode_t          entry  = {};
+    hmulti_t           mentry = {};
+
+    // a lookup never consumes more than HUFFMAN_MAX_CODE_LENGTH bits, so the refills keep the same cadence as decode_stream()
+    while ((i + HUFFMAN_SYMBOLS_PER_FLUSH * HUFFMAN_MULTI_SYMBOLS <= size) && bitreader_has_word(&reader)) {
+        bitreader_refill_fast(&reader);
+        for (unsigned j = 0; j < HUFFMAN_SYMBOLS_PER_FLUSH; ++j) {
+            mentry = multi[peek_bits(&reader, HUFFMAN_DECODE_TABLE_BITS)];
+            if (mentry.count) [[likely]] {
+                memcpy(outbuffer + i, mentry.symbols, HUFFMAN_MULTI_SYMBOLS);
+                i += mentry.count;
+                consume_bits(&reader, mentry.length);
+            } else {
+                entry          = decode_symbol(table, reader.window);
+                outbuffer[i++] = (unsigned char) entry.value;
+                consume_bits(&reader, entry.length);
+            }
+        }
+    }
+
+    return decode_stream(reader, table, outbuffer + i, size - i);
 }
 
+// decode_block_x4() with the multi symbol table, the four bitstreams move through their segments at their own pace
+static inline bool decode_block_x4_multi(
+    const unsigned char* const restrict bitstreams,
+    const unsigned* const restrict jumptable,
+    const hdecode_t* const restrict table,
+    const hmulti_t* const restrict multi,
+    unsigned char* const restrict outbuffer,
+    const unsigned long long size
+) {
+    assert(bitstreams);
+    assert(jumptable);
+    assert(table);
+    assert(multi);
+    assert(outbuffer);
+    assert(size >= 9);
+
+    const unsigned long long segsize    = (size + 3) / 4;
+    const unsigned long long sizes[4]   = { segsize, segsize, segsize, size - 3 * segsize };
+    const unsigned char*     stream     = bitstreams;
+    bitreader_t              readers[4] = {};
+    unsigned long long       i[4]       = { 0 };
+    hmulti_t                 mentry     = {};
+    hdecode_t                entry      = {};
+
+    for (unsigned k = 0; k < 4; ++k) {
+        bitreader_init(readers + k, stream, jumptable[k]);
+        stream += jumptable[k];
+    }
+
+    while (true) {
+        bool is_roomy = true; // do all four segments and bitstreams have room for another round
+        for (unsigned k = 0; k < 4; ++k)
+            is_roomy &= (i[k] + HUFFMAN_SYMBOLS_PER_FLUSH * HUFFMAN_MULTI_SYMBOLS <= sizes[k]) && bitreader_has_word(readers + k);
+        if (!is_roomy) break;
+
+        for (unsigned k = 0; k < 4; ++k) bitreader_refill_fast(readers + k);
+        for (unsigned j = 0; j < HUFFMAN_SYMBOLS_PER_FLUSH; ++j) {
+            for (unsigned k = 0; k < 4; ++k) {
+                unsigned char* const out = outbuffer + k * segsize + i[k];
+                mentry                   = multi[peek_bits(readers + k, HUFFMAN_DECODE_TABLE_BITS)];
+                if (mentry.count) [[likely]] {
+                    memcpy(out, mentry.symbols, HUFFMAN_MULTI_SYMBOLS);
+                    i[k] += mentry.count;
+                    consume_bits(readers + k, mentry.length);
+                } else {
+                    entry = decode_symbol(table, readers[k].window);
+                    *out  = (unsigned char) entry.value;
+                    i[k]++;
+                    consume_bits(readers + k, entry.length);
+                }
+            }
+        }
+    }
+
+    for (unsigned k = 0; k < 4; ++k) {
+        if (!decode_stream(readers[k], table, outbuffer + k * segsize + i[k], sizes[k] - i[k])) [[unlikely]]
+            return false;
+    }
+    return true;
+}
+
+// number of bytes decompress() will write when given this compressed stream
+[[nodiscard]] static inline unsigned long long decompressed_size(const unsigned char* const restrict inbuffer) {
+    assert(inbuffer);
+    unsigned long long size = 0;
+    memcpy(&size, inbuffer, sizeof(unsigned long long));
+    return size;
+}
+
+// decompresses a stream made by compress(), outbuffer must be at least decompressed_size(inbuffer) bytes long
+// returns the number of bytes written to outbuffer, 0 if the stream is malformed
 static inline unsigned long long decompress(
     const unsigned char* const restrict inbuffer, unsigned char* const restrict outbuffer, const unsigned long long size
 ) {
-    //
+    assert(inbuffer);
+
+    hdecode_t                  table[HUFFMAN_DECODE_TABLE_CAPACITY]     = {};
+    hmulti_t                   multi[1LLU << HUFFMAN_DECODE_TABLE_BITS] = {}; // 16 KiBs with the default 11 bit tables
+    hcode_t                    codes[BYTECOUNT]                         = {};
+    unsigned char              lengths[BYTECOUNT]                       = { 0 };
+    const unsigned char*       caret                                    = inbuffer + sizeof(unsigned long long);
+    const unsigned char* const end                                      = inbuffer + size;
+    unsigned long long         blocksize = 0, rawsize = 0; // NOLINT(readability-isolate-declaration)
+    unsigned                   nbytes = 0, jumptable[4] = { 0 }; // NOLINT(readability-isolate-declaration)
+    bitreader_t                reader                                   = {};
+
+    if (size < sizeof(unsigned long long)) [[unlikely]]
+        goto MALFORMED;
+    rawsize = decompressed_size(inbuffer);
+    assert(outbuffer || !rawsize); // empty buffers may come without storage
+
+    for (unsigned long long offset = 0; offset < rawsize; offset += blocksize) {
+        blocksize = (rawsize - offset) < HUFFMAN_BLOCK_SIZE ? (rawsize - offset) : HUFFMAN_BLOCK_SIZE;
+        if (caret >= end) [[unlikely]]
+            goto MALFORMED;
+
+        switch (*caret++) {
+            case BLOCK_STORED :
+                {
+                    if ((unsigned long long) (end - caret) < blocksize) [[unlikely]]
+                        goto MALFORMED;
+                    memcpy(outbuffer + offset, caret, blocksize);
+                    caret += blocksize;
+                    break;
+                }
+            case BLOCK_HUFFMAN :
+                {
+                    if ((unsigned long long) (end - caret) < sizeof(lengths) + sizeof(unsigned)) [[unlikely]]
+                        goto MALFORMED;
+                    memcpy(lengths, caret, sizeof(lengths));
+                    caret += sizeof(lengths);
+                    memcpy(&nbytes, caret, sizeof(unsigned));
+                    caret += sizeof(unsigned);
+
+                    if (((unsigned long long) (end - caret) < nbytes) || !build_canonical_codes(lengths, codes) ||
+                        !build_decode_table(codes, table)) [[unlikely]]
+                        goto MALFORMED;
+
+                    bitreader_init(&reader, caret, nbytes);
+                    if (prefers_multi_table(nbytes, blocksize)) {
+                        build_multi_table(table, multi);
+                        if (!decode_stream_multi(reader, table, multi, outbuffer + offset, blocksize)) [[unlikely]]
+                            goto MALFORMED;
+                    } else if (!decode_stream(reader, table, outbuffer + offset, blocksize)) [[unlikely]]
+                        goto MALFORMED;
+                    caret += nbytes;
+                    break;
+                }
+            case BLOCK_HUFFMAN_X4 :
+                {
+                    if ((blocksize < 9) || ((unsigned long long) (end - caret) < sizeof(lengths) + sizeof(jumptable))) [[unlikely]]
+                        goto MALFORMED;
+                    memcpy(lengths, caret, sizeof(lengths));
+                    caret += sizeof(lengths);
+                    memcpy(jumptable, caret, sizeof(jumptable));
+                    caret += sizeof(jumptable);
+
+                    const unsigned long long total = (unsigned long long) jumptable[0] + jumptable[1] + jumptable[2] + jumptable[3];
+                    if (((unsigned long long) (end - caret) < total) || !build_canonical_codes(lengths, codes) ||
+                        !build_decode_table(codes, table)) [[unlikely]]
+                        goto MALFORMED;
+
+                    if (prefers_multi_table(total, blocksize)) {
+                        build_multi_table(table, multi);
+                        if (!decode_block_x4_multi(caret, jumptable, table, multi, outbuffer + offset, blocksize)) [[unlikely]]
+                            goto MALFORMED;
+                    } else if (!decode_block_x4(caret, jumptable, table, outbuffer + offset, blocksize)) [[unlikely]]
+                        goto MALFORMED;
+                    caret += total;
+                    break;
+                }
+            default : goto MALFORMED;
+        }
+    }
+
+    return rawsize;
+
+MALFORMED:
+    fprintf(stderr, "Error in %s at line %d:: %s was given a malformed stream\n", __FILE__, __LINE__, __FUNCTION__);
+    return 0;
 }
@@ -6,6 +6,8 @@
 
 #define DEFAULT_PQUEUE_CAPACITY       1024LLU
 #define DEFAULT_PQUEUE_CAPACITY_BYTES (DEFAULT_PQUEUE_CAPACITY * sizeof(uintptr_t))
+#define PQUEUE_GROWTH_FACTOR          2LLU // a full queue multiplies its capacity by this much, so N pushes copy O(N) elements in total
+// #define PQUEUE_SHRINK_ON_POP // define to have pops give memory back once the queue is down to 1 / PQUEUE_GROWTH_FACTOR^2 of its capacity
 
 // many problems demand retrieval of the smallest or largest element stored a collection which is capable of frequent insertions and deletions
 // one way to meet this requirement is to keep the collection sorted all the time but sorting a collection after every insertion or deletion is expensive
@@ -87,6 +89,14 @@ static_assert(offsetof(pqueue, capacity) == 4);
 static_assert(offsetof(pqueue, predptr) == 8);
 static_assert(offsetof(pqueue, tree) == 16);
 
+// the capacity a queue grows to from its current capacity to hold at least needed elements, clamped to what the 32 bit counts can hold
+// unless needed itself does not fit, the *_reserve() functions report that
+[[nodiscard]] static inline unsigned long long pqueue_grown_capacity(const unsigned long long capacity, const unsigned long long needed) {
+    unsigned long long grown = capacity ? capacity : DEFAULT_PQUEUE_CAPACITY;
+    while (grown < needed) grown *= PQUEUE_GROWTH_FACTOR;
+    return (grown > UINT32_MAX) && (needed <= UINT32_MAX) ? UINT32_MAX : grown;
+}
+
 /*
 // must return true whenever a swap is needed.
 static inline bool  predicate(const void* const  child, const void* const  parent){
@@ -116,6 +126,56 @@ static inline bool pqueue_init(
     return true;
 }
 
+// makes room for at least capacity nodes, so that many pushes will not reallocate, never shrinks the queue
+static inline bool pqueue_reserve(pqueue* const restrict prqueue, const unsigned long long capacity) {
+    assert(prqueue);
+
+    void** _temp_tree = nullptr; // NOLINT(bugprone-multi-level-implicit-pointer-conversion)
+    if (capacity <= prqueue->capacity) return true;
+    if (capacity > UINT32_MAX) [[unlikely]] {
+        fprintf(
+            stderr,
+            "Error in %s at line %d:: %s was asked for %llu nodes, more than a pqueue can count\n",
+            __FILE__,
+            __LINE__,
+            __FUNCTION__,
+            capacity
+        );
+        return false;
+    }
+
+    // NOLINTNEXTLINE(bugprone-assignment-in-if-condition, bugprone-multi-level-implicit-pointer-conversion)
+    if (!(_temp_tree = (void**) realloc(prqueue->tree, capacity * sizeof(uintptr_t)))) [[unlikely]] {
+        fprintf(stderr, "Error in %s at line %d:: realloc failed inside %s\n", __FILE__, __LINE__, __FUNCTION__);
+        return false; // at this point, prqueue->tree is still valid and points to the old buffer
+    }
+
+    prqueue->tree     = _temp_tree;
+    prqueue->capacity = (unsigned) capacity;
+    return true;
+}
+
+// shrinks the buffer to capacity nodes, but never below the node count or the DEFAULT_PQUEUE_CAPACITY pqueue_init() starts with
+static inline bool pqueue_shrink_to(pqueue* const restrict prqueue, unsigned long long capacity) {
+    assert(prqueue);
+
+    void** _temp_tree = nullptr; // NOLINT(bugprone-multi-level-implicit-pointer-conversion)
+    if (capacity < prqueue->count) capacity = prqueue->count;
+    if (capacity < DEFAULT_PQUEUE_CAPACITY) capacity = DEFAULT_PQUEUE_CAPACITY;
+    if (capacity >= prqueue->capacity) return true;
+
+    // NOLINTNEXTLINE(bugprone-assignment-in-if-condition, bugprone-multi-level-implicit-pointer-conversion)
+    if (!(_temp_tree = (void**) realloc(prqueue->tree, capacity * sizeof(uintptr_t)))) [[unlikely]]
+        return false; // the old, larger buffer is still valid
+
+    prqueue->tree     = _temp_tree;
+    prqueue->capacity = (unsigned) capacity;
+    return true;
+}
+
+// gives back the memory beyond what the queue's nodes need
+static inline bool pqueue_shrink_to_fit(pqueue* const restrict prqueue) { return pqueue_shrink_to(prqueue, prqueue->count); }
+
 static inline void pqueue_clean(pqueue* const restrict prqueue) {
     for (size_t i = 0; i < prqueue->count; ++i) free(prqueue->tree[i]); // free the heap allocated nodes.
     free(prqueue->tree);                                                // NOLINT(bugprone-multi-level-implicit-pointer-conversion)
@@ -129,25 +189,14 @@ static inline bool pqueue_push(
     assert(prqueue);
     assert(data);
 
-    void * _temp_node = nullptr, **_temp_tree = nullptr; // NOLINT(readability-isolate-declaration)
-    size_t _childpos = 0, _parentpos = 0;                // NOLINT(readability-isolate-declaration)
-
-    // if the current buffer doesn't have space for another pointer, ask for an additional DEFAULT_PQUEUE_CAPACITY_BYTES bytes.
-    if (prqueue->count + 1 > prqueue->capacity) {
-        // NOLINTBEGIN(bugprone-assignment-in-if-condition, bugprone-multi-level-implicit-pointer-conversion)
-        if (!(_temp_tree = (void**) realloc(
-                  prqueue->tree,
-                  (prqueue->capacity * sizeof(uintptr_t)) /* size of the existing buffer in bytes */ + DEFAULT_PQUEUE_CAPACITY_BYTES
-              ))) [[unlikely]] {
-            // NOLINTEND(bugprone-assignment-in-if-condition, bugprone-multi-level-implicit-pointer-conversion)
-            fprintf(stderr, "Error in %s at line %d:: realloc failed inside %s\n", __FILE__, __LINE__, __FUNCTION__);
-            // at this point, prqueue->tree is still valid and points to the old buffer
-            return false; // return false if reallocation fails.
-        }
-
-        prqueue->tree      = _temp_tree;              // reallocation succeeded, reassign the new memory block to tree.
-        prqueue->capacity += DEFAULT_PQUEUE_CAPACITY; // update the capacity
-    }
+    void*  _temp_node = nullptr;
+    size_t _childpos = 0, _parentpos = 0; // NOLINT(readability-isolate-declaration)
+
+    // if the current buffer doesn't have space for another pointer, grow it by PQUEUE_GROWTH_FACTOR.
+    // at this point, prqueue->tree is still valid and points to the old buffer if the reallocation fails
+    if ((prqueue->count + 1 > prqueue->capacity) &&
+        !pqueue_reserve(prqueue, pqueue_grown_capacity(prqueue->capacity, prqueue->count + 1LLU))) [[unlikely]]
+        return false;
 
     // consider our previous tree:
     // { 25, 20, 22, 17, 19, 10, 12, 15, 07, 09, 18 }
@@ -393,7 +442,397 @@ static inline bool pqueue_pop(
      */
     // no rearrangements needed anymore.
 
+#ifdef PQUEUE_SHRINK_ON_POP
+    // halve the buffer once it is a quarter full, shrinking at half full would make a queue hovering around a growth boundary
+    // reallocate on every other push and pop
+    if (prqueue->capacity > DEFAULT_PQUEUE_CAPACITY && prqueue->count <= prqueue->capacity / (PQUEUE_GROWTH_FACTOR * PQUEUE_GROWTH_FACTOR))
+        pqueue_shrink_to(prqueue, prqueue->capacity / PQUEUE_GROWTH_FACTOR);
+#endif
+
     return true;
 }
 
 static inline void* pqueue_peek(const pqueue* const restrict prqueue) { return prqueue->tree ? prqueue->tree[0] : nullptr; }
+
+// moves the hole at pos down to where node belongs, pulling the heavier child up at every level, and puts node there
+static inline void pqueue_sift_down(pqueue* const restrict prqueue, size_t pos, void* const node) {
+    size_t _leftchildpos = 0, _rightchildpos = 0, _pos = 0; // NOLINT(readability-isolate-declaration)
+
+    while ((_leftchildpos = lchild_position(pos)) < prqueue->count) {
+        _rightchildpos = rchild_position(pos);
+        _pos           = _leftchildpos;
+        if ((_rightchildpos < prqueue->count) && (*prqueue->predptr)(prqueue->tree[_rightchildpos], prqueue->tree[_leftchildpos]))
+            _pos = _rightchildpos;
+        if (!(*prqueue->predptr)(prqueue->tree[_pos], node)) break;
+
+        prqueue->tree[pos] = prqueue->tree[_pos];
+        pos                = _pos;
+    }
+    prqueue->tree[pos] = node;
+}
+
+// gives up the node at the top and puts data in its place with a single sift down, rather than the sift down of a pqueue_pop()
+// followed by the sift up of a pqueue_push(), unlike pqueue_pop() this never cleans the queue
+static inline bool pqueue_replace_top(pqueue* const restrict prqueue, void* const restrict data, void** const restrict popped) {
+    assert(prqueue);
+    assert(popped);
+
+    if (!prqueue->count) [[unlikely]] {
+        *popped = nullptr;
+        return false;
+    }
+
+    *popped = prqueue->tree[0];
+    pqueue_sift_down(prqueue, 0, data);
+    return true;
+}
+
+// pushes data then pops the top, when data would be the new top it comes straight back without the heap being touched
+static inline void pqueue_pushpop(pqueue* const restrict prqueue, void* const restrict data, void** const restrict popped) {
+    assert(prqueue);
+    assert(popped);
+
+    if (!prqueue->count || !(*prqueue->predptr)(prqueue->tree[0], data)) {
+        *popped = data;
+        return;
+    }
+
+    *popped = prqueue->tree[0];
+    pqueue_sift_down(prqueue, 0, data);
+}
+
+// appends count nodes and restores the heap, a batch at least as large as the queue is heapified bottom up (Floyd) in O(n), i.e
+// every parent starting from the last one is sifted down over its subtrees, which are heaps already, rather than sifting the nodes
+// up one at a time in O(n log n). a smaller batch is pushed one node at a time, as that only has to fix up the paths it touches
+static inline bool pqueue_push_bulk(pqueue* const restrict prqueue, void* const* const restrict nodes, const unsigned long long count) {
+    assert(prqueue);
+    assert(nodes || !count);
+
+    if (!pqueue_reserve(prqueue, pqueue_grown_capacity(prqueue->capacity, prqueue->count + count))) [[unlikely]] return false;
+
+    if (count < prqueue->count) {
+        for (unsigned long long i = 0; i < count; ++i) pqueue_push(prqueue, nodes[i]);
+        return true;
+    }
+
+    memcpy(prqueue->tree + prqueue->count, nodes, count * sizeof(uintptr_t)); // NOLINT(bugprone-multi-level-implicit-pointer-conversion)
+    prqueue->count += (unsigned) count;
+
+    for (size_t pos = prqueue->count / 2; pos-- > 0;) pqueue_sift_down(prqueue, pos, prqueue->tree[pos]);
+    return true;
+}
+
+// initializes the queue with the count nodes in the array
+static inline bool pqueue_from_array(
+    pqueue* const restrict prqueue,
+    void* const* const restrict nodes,
+    const unsigned long long count,
+    bool (*const predicate)(const void* const restrict child, const void* const restrict parent)
+) {
+    if (!pqueue_init(prqueue, predicate)) [[unlikely]] return false;
+    if (!pqueue_push_bulk(prqueue, nodes, count)) [[unlikely]] {
+        pqueue_clean(prqueue); // nothing made it into the queue, so no caller owned node gets free()d
+        return false;
+    }
+    return true;
+}
+
+//-------------------------------------------------------------------------------------------------------------------------------//
+//                          A VARIANT OF THE PRIORITY QUEUE THAT STORES THE ELEMENTS THEMSELVES                                  //
+//-------------------------------------------------------------------------------------------------------------------------------//
+
+// pqueue holds pointers to individually malloc()ed nodes, so every push costs an allocation and every comparison a pointer chase
+// vpqueue copies the elements into one contiguous buffer instead, elements are moved by value and the caller's copy can be reused
+// right after a push. unlike pqueue, giving up the last element does not clean the queue, so it can be refilled
+
+typedef struct _vpqueue {                 // priority queue of values
+        unsigned           count;        // number of elements.
+        unsigned           capacity;     // number of elements the prqueue can hold before requiring a reallocation.
+        unsigned long long size;         // size of an element in bytes.
+        bool               (*predptr)(const void* const, const void* const); // same contract as pqueue's predicate.
+        unsigned char*     tree;         // a heap allocated array holding the elements back to back.
+} vpqueue;
+
+static_assert(sizeof(vpqueue) == 32);
+static_assert(offsetof(vpqueue, count) == 0);
+static_assert(offsetof(vpqueue, capacity) == 4);
+static_assert(offsetof(vpqueue, size) == 8);
+static_assert(offsetof(vpqueue, predptr) == 16);
+static_assert(offsetof(vpqueue, tree) == 24);
+
+static inline bool vpqueue_init(
+    vpqueue* const restrict prqueue,
+    const unsigned long long size,
+    bool (*const predicate)(const void* const restrict child, const void* const restrict parent)
+) {
+    assert(prqueue);
+    assert(size);
+    assert(predicate);
+
+    if (!(prqueue->tree = (unsigned char*) malloc(DEFAULT_PQUEUE_CAPACITY * size))) [[unlikely]] { // NOLINT(bugprone-assignment-in-if-condition)
+        fprintf(stderr, "Error in %s at line %d:: malloc failed inside %s\n", __FILE__, __LINE__, __FUNCTION__);
+        return false;
+    }
+
+    prqueue->count    = 0;
+    prqueue->capacity = DEFAULT_PQUEUE_CAPACITY; // this is the number of elements, NOT BYTES
+    prqueue->size     = size;
+    prqueue->predptr  = predicate;
+    return true;
+}
+
+// makes room for at least capacity elements, so that many pushes will not reallocate, never shrinks the queue
+static inline bool vpqueue_reserve(vpqueue* const restrict prqueue, const unsigned long long capacity) {
+    assert(prqueue);
+
+    unsigned char* _temp_tree = nullptr;
+    if (capacity <= prqueue->capacity) return true;
+    if (capacity > UINT32_MAX) [[unlikely]] {
+        fprintf(
+            stderr,
+            "Error in %s at line %d:: %s was asked for %llu elements, more than a vpqueue can count\n",
+            __FILE__,
+            __LINE__,
+            __FUNCTION__,
+            capacity
+        );
+        return false;
+    }
+
+    // NOLINTNEXTLINE(bugprone-assignment-in-if-condition)
+    if (!(_temp_tree = (unsigned char*) realloc(prqueue->tree, capacity * prqueue->size))) [[unlikely]] {
+        fprintf(stderr, "Error in %s at line %d:: realloc failed inside %s\n", __FILE__, __LINE__, __FUNCTION__);
+        return false; // prqueue->tree is still valid and points to the old buffer
+    }
+
+    prqueue->tree     = _temp_tree;
+    prqueue->capacity = (unsigned) capacity;
+    return true;
+}
+
+// same contract as pqueue_shrink_to()
+static inline bool vpqueue_shrink_to(vpqueue* const restrict prqueue, unsigned long long capacity) {
+    assert(prqueue);
+
+    unsigned char* _temp_tree = nullptr;
+    if (capacity < prqueue->count) capacity = prqueue->count;
+    if (capacity < DEFAULT_PQUEUE_CAPACITY) capacity = DEFAULT_PQUEUE_CAPACITY;
+    if (capacity >= prqueue->capacity) return true;
+
+    // NOLINTNEXTLINE(bugprone-assignment-in-if-condition)
+    if (!(_temp_tree = (unsigned char*) realloc(prqueue->tree, capacity * prqueue->size))) [[unlikely]]
+        return false; // the old, larger buffer is still valid
+
+    prqueue->tree     = _temp_tree;
+    prqueue->capacity = (unsigned) capacity;
+    return true;
+}
+
+static inline bool vpqueue_shrink_to_fit(vpqueue* const restrict prqueue) { return vpqueue_shrink_to(prqueue, prqueue->count); }
+
+static inline void vpqueue_clean(vpqueue* const restrict prqueue) {
+    assert(prqueue);
+    free(prqueue->tree);
+    memset(prqueue, 0U, sizeof(vpqueue));
+}
+
+// the workhorses of vpqueue_push() and vpqueue_pop(), with the element size and the predicate as arguments rather than read from
+// the queue, when both are compile time constants at the call site, the compiler can inline the predicate and the memcpy()s
+static inline bool vpqueue_push_with(
+    vpqueue* const restrict prqueue,
+    const void* const restrict data,
+    const unsigned long long size,
+    bool (*const predicate)(const void* const restrict child, const void* const restrict parent)
+) {
+    assert(prqueue);
+    assert(data);
+    assert(size == prqueue->size);
+
+    unsigned long long _childpos = prqueue->count, _parentpos = 0; // NOLINT(readability-isolate-declaration)
+
+    if ((prqueue->count + 1 > prqueue->capacity) &&
+        !vpqueue_reserve(prqueue, pqueue_grown_capacity(prqueue->capacity, prqueue->count + 1LLU))) [[unlikely]]
+        return false; // prqueue->tree is still valid and points to the old buffer
+
+    // rather than swapping the new element up level by level, move the parents it outranks down a level and write it in once
+    while (_childpos > 0) {
+        _parentpos = parent_position(_childpos);
+        if (!(*predicate)(data, prqueue->tree + _parentpos * size)) break;
+        memcpy(prqueue->tree + _childpos * size, prqueue->tree + _parentpos * size, size);
+        _childpos = _parentpos;
+    }
+    memcpy(prqueue->tree + _childpos * size, data, size);
+    prqueue->count++;
+
+    return true;
+}
+
+// moves the hole at pos down to where node belongs and copies node in, node must not live in the slots the hole can visit,
+// i.e. in [pos, prqueue->count), the slot right past the last element is a good place to park it
+static inline void vpqueue_sift_down_with(
+    vpqueue* const restrict prqueue,
+    unsigned long long pos,
+    const void* const restrict node,
+    const unsigned long long size,
+    bool (*const predicate)(const void* const restrict child, const void* const restrict parent)
+) {
+    unsigned long long _leftchildpos = 0, _rightchildpos = 0, _pos = 0; // NOLINT(readability-isolate-declaration)
+
+    while (true) {
+        _leftchildpos  = lchild_position(pos);
+        _rightchildpos = rchild_position(pos);
+        if (_leftchildpos >= prqueue->count) break;
+
+        _pos = _leftchildpos;
+        if ((_rightchildpos < prqueue->count) && (*predicate)(prqueue->tree + _rightchildpos * size, prqueue->tree + _leftchildpos * size))
+            _pos = _rightchildpos;
+        if (!(*predicate)(prqueue->tree + _pos * size, node)) break;
+
+        memcpy(prqueue->tree + pos * size, prqueue->tree + _pos * size, size);
+        pos = _pos;
+    }
+    memcpy(prqueue->tree + pos * size, node, size);
+}
+
+static inline bool vpqueue_pop_with(
+    vpqueue* const restrict prqueue,
+    void* const restrict popped, /* a buffer of at least prqueue->size bytes */
+    const unsigned long long size,
+    bool (*const predicate)(const void* const restrict child, const void* const restrict parent)
+) {
+    assert(prqueue);
+    assert(popped);
+    assert(size == prqueue->size);
+
+    if (!prqueue->count) return false;
+
+    memcpy(popped, prqueue->tree, size);
+    prqueue->count--;
+
+    // the last element has to move into the hole at the root, it stays where it is while the hole sifts down to where it belongs,
+    // the hole only ever visits slots before it, so it is never overwritten
+    if (prqueue->count) vpqueue_sift_down_with(prqueue, 0, prqueue->tree + prqueue->count * size, size, predicate);
+
+#ifdef PQUEUE_SHRINK_ON_POP
+    if (prqueue->capacity > DEFAULT_PQUEUE_CAPACITY && prqueue->count <= prqueue->capacity / (PQUEUE_GROWTH_FACTOR * PQUEUE_GROWTH_FACTOR))
+        vpqueue_shrink_to(prqueue, prqueue->capacity / PQUEUE_GROWTH_FACTOR);
+#endif
+
+    return true;
+}
+
+// enqueue, copies size bytes from data into the queue
+static inline bool vpqueue_push(vpqueue* const restrict prqueue, const void* const restrict data) {
+    return vpqueue_push_with(prqueue, data, prqueue->size, prqueue->predptr);
+}
+
+// dequeue, copies the element at the top into popped
+static inline bool vpqueue_pop(vpqueue* const restrict prqueue, void* const restrict popped) {
+    return vpqueue_pop_with(prqueue, popped, prqueue->size, prqueue->predptr);
+}
+
+// copies the element at the top into popped and puts a copy of data in its place with a single sift down
+static inline bool vpqueue_replace_top_with(
+    vpqueue* const restrict prqueue,
+    const void* const restrict data,
+    void* const restrict popped, /* a buffer of at least prqueue->size bytes */
+    const unsigned long long size,
+    bool (*const predicate)(const void* const restrict child, const void* const restrict parent)
+) {
+    assert(prqueue);
+    assert(data);
+    assert(popped);
+    assert(size == prqueue->size);
+
+    if (!prqueue->count) [[unlikely]] return false;
+
+    memcpy(popped, prqueue->tree, size);
+    vpqueue_sift_down_with(prqueue, 0, data, size, predicate);
+    return true;
+}
+
+// pushes data then pops the top into popped, when data would be the new top it is copied straight to popped
+static inline void vpqueue_pushpop_with(
+    vpqueue* const restrict prqueue,
+    const void* const restrict data,
+    void* const restrict popped, /* a buffer of at least prqueue->size bytes */
+    const unsigned long long size,
+    bool (*const predicate)(const void* const restrict child, const void* const restrict parent)
+) {
+    assert(prqueue);
+    assert(data);
+    assert(popped);
+    assert(size == prqueue->size);
+
+    if (!prqueue->count || !(*predicate)(prqueue->tree, data)) {
+        memcpy(popped, data, size);
+        return;
+    }
+
+    memcpy(popped, prqueue->tree, size);
+    vpqueue_sift_down_with(prqueue, 0, data, size, predicate);
+}
+
+static inline bool vpqueue_replace_top(vpqueue* const restrict prqueue, const void* const restrict data, void* const restrict popped) {
+    return vpqueue_replace_top_with(prqueue, data, popped, prqueue->size, prqueue->predptr);
+}
+
+static inline void vpqueue_pushpop(vpqueue* const restrict prqueue, const void* const restrict data, void* const restrict popped) {
+    vpqueue_pushpop_with(prqueue, data, popped, prqueue->size, prqueue->predptr);
+}
+
+// appends count elements stored back to back at data and restores the heap, a batch at least as large as the queue is heapified
+// bottom up (Floyd) in O(n) rather than sifted up one element at a time in O(n log n)
+static inline bool vpqueue_push_bulk_with(
+    vpqueue* const restrict prqueue,
+    const void* const restrict data,
+    const unsigned long long count,
+    const unsigned long long size,
+    bool (*const predicate)(const void* const restrict child, const void* const restrict parent)
+) {
+    assert(prqueue);
+    assert(data || !count);
+    assert(size == prqueue->size);
+
+    const unsigned long long _oldcount = prqueue->count;
+
+    // one slot more than needed, to park the element being sifted down
+    if (!vpqueue_reserve(prqueue, pqueue_grown_capacity(prqueue->capacity, prqueue->count + count + 1LLU))) [[unlikely]] return false;
+
+    if (count < _oldcount) {
+        for (unsigned long long i = 0; i < count; ++i) vpqueue_push_with(prqueue, (const unsigned char*) data + i * size, size, predicate);
+        return true;
+    }
+
+    memcpy(prqueue->tree + _oldcount * size, data, count * size);
+    prqueue->count += (unsigned) count;
+
+    unsigned char* const _parked = prqueue->tree + prqueue->count * size;
+    for (unsigned long long pos = prqueue->count / 2; pos-- > 0;) { // leaves are heaps already, start from the last parent
+        memcpy(_parked, prqueue->tree + pos * size, size);
+        vpqueue_sift_down_with(prqueue, pos, _parked, size, predicate);
+    }
+    return true;
+}
+
+static inline bool vpqueue_push_bulk(vpqueue* const restrict prqueue, const void* const restrict data, const unsigned long long count) {
+    return vpqueue_push_bulk_with(prqueue, data, count, prqueue->size, prqueue->predptr);
+}
+
+// initializes the queue with count elements stored back to back at data
+static inline bool vpqueue_from_array(
+    vpqueue* const restrict prqueue,
+    const void* const restrict data,
+    const unsigned long long count,
+    const unsigned long long size,
+    bool (*const predicate)(const void* const restrict child, const void* const restrict parent)
+) {
+    if (!vpqueue_init(prqueue, size, predicate)) [[unlikely]] return false;
+    if (!vpqueue_push_bulk_with(prqueue, data, count, size, predicate)) [[unlikely]] {
+        vpqueue_clean(prqueue);
+        return false;
+    }
+    return true;
+}
+
+static inline const void* vpqueue_peek(const vpqueue* const restrict prqueue) { return prqueue->count ? prqueue->tree : nullptr; }
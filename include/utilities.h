@@ -1,8 +1,15 @@
 #pragma once
 
+#ifndef _GNU_SOURCE // madvise(), fallocate() and the flags <fileio.h> passes them are hidden in the strict ISO C modes
+    #define _GNU_SOURCE
+#endif
+
 #include <assert.h>
 #include <errno.h>
+#include <limits.h>
 #include <malloc.h>
+#include <pthread.h>
+#include <stdalign.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -12,7 +19,9 @@
 #include <unistd.h>
 
 #include <sys/fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 #if defined(__TEST__) && defined(__VERBOSE_TEST_IO__)
     #define dbgprinf(...) fprintf(stderr, __VA_ARGS__)
@@ -4,10 +4,10 @@
 #include <huffman.h>
 
 static unsigned long long frequencies[BYTECOUNT]                            = { 0 }; // 2KiBs
-static btnode_t           pqueue_buffer[GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY] = { 0 }; // 32KiBs - for use with priority queues
-static btnode_t           bntree_buffer[GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY] = { 0 }; // 32KiBs - for use with binary trees
+static btnode_t           pqueue_buffer[GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY] = { 0 }; // 8KiBs - for use with priority queues
+static btnode_t           bntree_buffer[GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY] = { 0 }; // 8KiBs - for use with binary trees
 
-// the whole buffer being just 32KiBs, can probably fit in the CPU's caches :))
+// the whole buffer being just 8KiBs, can probably fit in the CPU's caches :))
 
 int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
     long                       filesize   = 0;
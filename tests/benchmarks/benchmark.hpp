@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#include <x86intrin.h>
+
+// a tiny benchmark harness in the spirit of gtest's TEST(), each BENCHMARK() enlists itself before main() runs
+// timings are in TSC ticks, which run at the nominal clock rate of the processor irrespective of turbo or power states
+
+namespace benchmark {
+
+    struct entry final {
+            const char* name;
+            void (*routine)();
+    };
+
+    [[nodiscard]] inline std::vector<entry>& registry() noexcept {
+        static std::vector<entry> entries {};
+        return entries;
+    }
+
+    inline bool enlist(const char* const name, void (*const routine)()) {
+        registry().push_back({ name, routine });
+        return true;
+    }
+
+    static constexpr const char* const test_files[] = { R"(./files/bronze.jpg)", R"(./files/mobydick.txt)", R"(./files/synth.bin)", R"(./files/table.csv)" };
+
+    // runs the callable repeats times and returns the fewest ticks a single run took, the minimum is the least noisy estimate
+    template<typename callable_type> [[nodiscard]] unsigned long long ticks(callable_type&& callable, const unsigned repeats = 64) {
+        unsigned long long fewest = ~0LLU, start = 0; // NOLINT(readability-isolate-declaration)
+        for (unsigned i = 0; i < repeats; ++i) {
+            start = __rdtsc();
+            callable();
+            const unsigned long long elapsed = __rdtsc() - start;
+            if (elapsed < fewest) fewest = elapsed;
+        }
+        return fewest;
+    }
+
+    inline void report(const char* const routine, const char* const input, const unsigned long long nbytes, const unsigned long long nticks) {
+        ::printf("%-36s %-24s %12llu bytes %12llu ticks %8.3f bytes/tick\n", routine, input, nbytes, nticks, static_cast<double>(nbytes) / nticks);
+    }
+
+    // keeps the compiler from discarding the results of a benchmarked routine
+    template<typename value_type> inline void sink(const value_type& value) noexcept { asm volatile("" : : "r,m"(value) : "memory"); }
+
+} // namespace benchmark
+
+#define BENCHMARK(name)                                                                                                                 \
+    static void       name();                                                                                                            \
+    static const bool name##_is_enlisted = benchmark::enlist(#name, name);                                                               \
+    static void       name()
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <vector>
+
+#include <benchmark.hpp>
+
+extern "C" {
+#define restrict
+#include <bintree.h>
+#undef restrict
+}
+
+// number of nodes reachable from node, visited depth first as a traversal for locality's sake
+[[nodiscard]] static unsigned long long count_nodes(const btnode* const node) noexcept { // NOLINT(misc-no-recursion)
+    return node ? 1 + count_nodes(node->left) + count_nodes(node->right) : 0;
+}
+
+// what bntree_remove() used to do, a free() after the recursive calls for both children
+static void free_recursively(btnode* const node) noexcept { // NOLINT(misc-no-recursion)
+    if (!node) return;
+    free_recursively(node->left);
+    free_recursively(node->right);
+    ::free(node);
+}
+
+static void count_node(btnode* const, void* const context) noexcept { ++*reinterpret_cast<unsigned long long*>(context); }
+
+BENCHMARK(bntree_arena) {
+    std::vector<unsigned long long> data(1'000'000);
+    std::vector<btnode*>            nodes(data.size());
+    const unsigned long long        nbytes = data.size() * sizeof(btnode);
+
+    // a complete tree built level by level, as build, walk and tear down
+    const auto build = [&](bntree* const tree) noexcept -> void {
+        ::bntree_insert(tree, nullptr, ROOT, &data[0]);
+        nodes[0] = tree->root;
+        for (size_t i = 1; i < data.size(); ++i) {
+            btnode* const parent = nodes[(i - 1) / 2];
+            ::bntree_insert(tree, parent, i % 2 ? LEFT : RIGHT, &data[i]);
+            nodes[i] = i % 2 ? parent->left : parent->right;
+        }
+    };
+
+    ::bnarena arena {};
+    ::bnarena_init(&arena, 0);
+    for (auto* const backing : { static_cast<bnarena*>(nullptr), &arena }) {
+        const char* const routine = backing ? "arena" : "malloc";
+        ::bntree          tree {};
+        ::bntree_init(&tree, backing);
+
+        build(&tree);
+        benchmark::report(routine, "walk 1M nodes", nbytes, benchmark::ticks([&]() noexcept -> void {
+                              benchmark::sink(count_nodes(tree.root));
+                          }, 4));
+        ::bntree_release(&tree);
+        benchmark::report(routine, "build + release 1M nodes", nbytes, benchmark::ticks([&]() noexcept -> void {
+                              build(&tree);
+                              ::bntree_release(&tree);
+                          }, 4));
+    }
+    ::bnarena_release(&arena);
+}
+
+BENCHMARK(bntree_traversal) {
+    std::vector<unsigned long long> data(1'000'000);
+    std::vector<btnode*>            nodes(data.size()), stack(data.size());
+    const unsigned long long        nbytes = data.size() * sizeof(btnode);
+    unsigned long long              count {};
+    ::bntree                        tree {};
+    ::bntree_init(&tree, nullptr);
+
+    const auto build = [&]() noexcept -> void {
+        ::bntree_insert(&tree, nullptr, ROOT, &data[0]);
+        nodes[0] = tree.root;
+        for (size_t i = 1; i < data.size(); ++i) {
+            btnode* const parent = nodes[(i - 1) / 2];
+            ::bntree_insert(&tree, parent, i % 2 ? LEFT : RIGHT, &data[i]);
+            nodes[i] = i % 2 ? parent->left : parent->right;
+        }
+    };
+
+    build();
+    benchmark::report("recursive", "pre-order 1M nodes", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          benchmark::sink(count_nodes(tree.root));
+                      }, 8));
+    benchmark::report("bntree_preorder", "pre-order 1M nodes", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          count = 0;
+                          ::bntree_preorder(&tree, stack.data(), stack.size(), count_node, &count);
+                          benchmark::sink(count);
+                      }, 8));
+    benchmark::report("bntree_inorder", "in-order 1M nodes", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          count = 0;
+                          ::bntree_inorder(&tree, stack.data(), stack.size(), count_node, &count);
+                          benchmark::sink(count);
+                      }, 8));
+    benchmark::report("bntree_postorder", "post-order 1M nodes", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          count = 0;
+                          ::bntree_postorder(&tree, stack.data(), stack.size(), count_node, &count);
+                          benchmark::sink(count);
+                      }, 8));
+    benchmark::report("bntree_levelorder", "level order 1M nodes", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          count = 0;
+                          ::bntree_levelorder(&tree, stack.data(), stack.size(), count_node, &count);
+                          benchmark::sink(count);
+                      }, 8));
+
+    // teardown only, the build is repeated outside the timed region
+    unsigned long long recursive = ~0LLU, rotating = ~0LLU; // NOLINT(readability-isolate-declaration)
+    for (unsigned i = 0; i < 4; ++i) {
+        recursive = std::min(recursive, benchmark::ticks([&]() noexcept -> void { free_recursively(tree.root); }, 1));
+        tree.root       = nullptr;
+        tree.node_count = 0;
+        build();
+        rotating = std::min(rotating, benchmark::ticks([&]() noexcept -> void { ::bntree_release(&tree); }, 1));
+        build();
+    }
+    benchmark::report("recursive free()", "teardown 1M nodes", nbytes, recursive);
+    benchmark::report("bntree_release", "teardown 1M nodes", nbytes, rotating);
+    ::bntree_release(&tree);
+}
@@ -0,0 +1,105 @@
+#include <random>
+#include <vector>
+
+#include <benchmark.hpp>
+
+extern "C" {
+#define restrict
+#include <bitops.h>
+#undef restrict
+}
+
+BENCHMARK(bitio) {
+    std::mt19937_64                 rndengine { 0x5EED };
+    std::vector<unsigned>           widths(1'000'000);
+    std::vector<unsigned long long> values(widths.size());
+    unsigned long long              nbits {};
+
+    // fields of 1 to 16 bits, the lengths a Huffman code table hands out
+    for (size_t i = 0; i < widths.size(); ++i) {
+        widths[i]  = 1 + rndengine() % 16;
+        values[i]  = rndengine() >> (64 - widths[i]);
+        nbits     += widths[i];
+    }
+
+    std::vector<unsigned char> buffer((nbits + 7) / 8 + sizeof(unsigned long long));
+    const unsigned long long   nbytes = (nbits + 7) / 8;
+
+    benchmark::report("setbit() x nbits", "1M fields", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          unsigned long long offset {};
+                          for (size_t i = 0; i < widths.size(); ++i)
+                              for (unsigned j = widths[i]; j; --j) ::setbit(buffer.data(), offset++, (values[i] >> (j - 1)) & 1);
+                          benchmark::sink(buffer.data());
+                      }, 8));
+    benchmark::report("put_bits()", "1M fields", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          ::bitwriter_t writer {};
+                          ::bitwriter_init(&writer, buffer.data());
+                          for (size_t i = 0; i < widths.size(); ++i) ::put_bits(&writer, widths[i], values[i]);
+                          benchmark::sink(::bitwriter_finish(&writer));
+                      }, 8));
+
+    benchmark::report("getbit() x nbits", "1M fields", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          unsigned long long offset {}, checksum {}; // NOLINT(readability-isolate-declaration)
+                          for (size_t i = 0; i < widths.size(); ++i) {
+                              unsigned long long value {};
+                              for (unsigned j = 0; j < widths[i]; ++j) value = (value << 1) | ::getbit(buffer.data(), offset++);
+                              checksum += value;
+                          }
+                          benchmark::sink(checksum);
+                      }, 8));
+    benchmark::report("peek_bits() + consume_bits()", "1M fields", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          ::bitreader_t      reader {};
+                          unsigned long long checksum {};
+                          ::bitreader_init(&reader, buffer.data(), nbytes);
+                          for (size_t i = 0; i < widths.size(); ++i) {
+                              ::bitreader_refill(&reader);
+                              checksum += ::peek_bits(&reader, widths[i]);
+                              ::consume_bits(&reader, widths[i]);
+                          }
+                          benchmark::sink(checksum);
+                      }, 8));
+}
+
+BENCHMARK(bitops_range) {
+    std::mt19937_64            rndengine { 0x5EED };
+    std::vector<unsigned char> buffer_a(1LLU << 20), buffer_b(buffer_a.size()), outbuff(buffer_a.size());
+    const unsigned long long   nbits = buffer_a.size() * 8 - 16; // 3 bits in, so neither end of the range is byte aligned
+
+    for (auto& byte : buffer_a) byte = static_cast<unsigned char>(rndengine());
+    for (auto& byte : buffer_b) byte = static_cast<unsigned char>(rndengine());
+
+    benchmark::report("xorbit() x nbits", "1 MiB", buffer_a.size(), benchmark::ticks([&]() noexcept -> void {
+                          for (unsigned long long i = 3; i < 3 + nbits; ++i) ::xorbit(buffer_a.data(), buffer_b.data(), outbuff.data(), i);
+                          benchmark::sink(outbuff.data());
+                      }, 4));
+    benchmark::report("xorbits()", "1 MiB", buffer_a.size(), benchmark::ticks([&]() noexcept -> void {
+                          ::xorbits(buffer_a.data(), buffer_b.data(), outbuff.data(), 3, nbits);
+                          benchmark::sink(outbuff.data());
+                      }));
+    benchmark::report("andbits()", "1 MiB", buffer_a.size(), benchmark::ticks([&]() noexcept -> void {
+                          ::andbits(buffer_a.data(), buffer_b.data(), outbuff.data(), 3, nbits);
+                          benchmark::sink(outbuff.data());
+                      }));
+
+    benchmark::report("setbit(getbit()) x nbits", "1 MiB", buffer_a.size(), benchmark::ticks([&]() noexcept -> void {
+                          for (unsigned long long i = 0; i < nbits; ++i) ::setbit(outbuff.data(), 5 + i, ::getbit(buffer_a.data(), 3 + i));
+                          benchmark::sink(outbuff.data());
+                      }, 4));
+    benchmark::report("copybits() (same alignment)", "1 MiB", buffer_a.size(), benchmark::ticks([&]() noexcept -> void {
+                          ::copybits(buffer_a.data(), 3, outbuff.data(), 3, nbits);
+                          benchmark::sink(outbuff.data());
+                      }));
+    benchmark::report("copybits() (shifted)", "1 MiB", buffer_a.size(), benchmark::ticks([&]() noexcept -> void {
+                          ::copybits(buffer_a.data(), 3, outbuff.data(), 5, nbits);
+                          benchmark::sink(outbuff.data());
+                      }));
+
+    benchmark::report("getbit() x nbits", "1 MiB", buffer_a.size(), benchmark::ticks([&]() noexcept -> void {
+                          unsigned long long count {};
+                          for (unsigned long long i = 3; i < 3 + nbits; ++i) count += ::getbit(buffer_a.data(), i);
+                          benchmark::sink(count);
+                      }, 4));
+    benchmark::report("popcount_range()", "1 MiB", buffer_a.size(), benchmark::ticks([&]() noexcept -> void {
+                          benchmark::sink(::popcount_range(buffer_a.data(), 3, nbits));
+                      }));
+}
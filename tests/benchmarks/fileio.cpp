@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <benchmark.hpp>
+
+extern "C" {
+#define restrict
+#include <huffman.h>
+#undef restrict
+}
+
+static constexpr const char* const corpus_path { R"(./files/corpus.tmp)" };
+static constexpr const char* const output_path { R"(./files/output.tmp)" };
+
+// writes the test files over and over into corpus_path until it is at least nbytes long, returns the size of the corpus, 0 on failure
+[[nodiscard]] static unsigned long long replicate_corpus(const unsigned long long nbytes) {
+    std::vector<unsigned char> files {};
+    long                       size {};
+
+    for (const auto& path : benchmark::test_files) {
+        unsigned char* const buffer = ::__read(path, &size);
+        if (!buffer) continue;
+        files.insert(files.end(), buffer, buffer + size);
+        ::free(buffer);
+    }
+    if (files.empty()) return 0;
+
+    FILE* const corpus = ::fopen(corpus_path, "wb");
+    if (!corpus) return 0;
+    unsigned long long written {};
+    while (written < nbytes && ::fwrite(files.data(), 1, files.size(), corpus) == files.size()) written += files.size();
+    ::fclose(corpus);
+    return written >= nbytes ? written : 0;
+}
+
+// copies the test files over and over into files of their own until the copies add up to at least nbytes, returns their paths,
+// none if any copy could not be written, a pipeline compressing many medium sized files reads a corpus like this
+[[nodiscard]] static std::vector<std::string> replicate_files(const unsigned long long nbytes) {
+    std::vector<std::string> paths {};
+    unsigned long long       written {};
+    long                     size {};
+
+    for (unsigned long long i = 0; written < nbytes; ++i) {
+        const char* const    source = benchmark::test_files[i % std::size(benchmark::test_files)];
+        unsigned char* const buffer = ::__read(source, &size);
+        paths.emplace_back("./files/corpus_" + std::to_string(i) + ".tmp");
+        if (!buffer || !::__write(paths.back().c_str(), buffer, size)) {
+            ::free(buffer);
+            for (const auto& path : paths) ::remove(path.c_str());
+            return {};
+        }
+        ::free(buffer);
+        written += size;
+    }
+    ::sync(); // dirty pages cannot be evicted from the page cache
+    return paths;
+}
+
+BENCHMARK(fileio_map) {
+    unsigned long long frequencies[BYTECOUNT] {};
+
+    // the files are in the page cache after the first run, so this is the cost of getting the bytes in front of scan_frequencies()
+    const auto compare = [&frequencies](const char* const path, const char* const input, const unsigned repeats) -> void {
+        long               size {};
+        unsigned long long nbytes {};
+        unsigned char*     probe = ::__read(path, &size);
+        if (!probe) return;
+        ::free(probe);
+
+        benchmark::report("__read() + scan_frequencies()", input, size, benchmark::ticks([&]() noexcept -> void {
+                              unsigned char* const buffer = ::__read(path, &size);
+                              ::scan_frequencies(buffer, size, frequencies);
+                              ::free(buffer);
+                              benchmark::sink(frequencies);
+                          }, repeats));
+        benchmark::report("__map() + scan_frequencies()", input, size, benchmark::ticks([&]() noexcept -> void {
+                              const unsigned char* const buffer = ::__map(path, &nbytes);
+                              ::scan_frequencies(buffer, nbytes, frequencies);
+                              ::__unmap(buffer, nbytes);
+                              benchmark::sink(frequencies);
+                          }, repeats));
+    };
+
+    for (const auto& path : benchmark::test_files) compare(path, path, 16);
+    if (replicate_corpus(512LLU << 20)) compare(corpus_path, "512 MiB corpus", 4);
+    ::remove(corpus_path);
+}
+
+BENCHMARK(fileio_stream) {
+    unsigned long long frequencies[BYTECOUNT] {};
+    unsigned long long partial[BYTECOUNT] {};
+
+    // the streamreader_t holds two chunks regardless of the file size where __read() holds the whole file, the histogram of each
+    // chunk is summed up as a streaming compressor would have to
+    const auto compare = [&](const char* const path, const char* const input, const unsigned repeats) -> void {
+        long           size {};
+        unsigned char* probe = ::__read(path, &size);
+        if (!probe) return;
+        ::free(probe);
+
+        benchmark::report("__read() + scan_frequencies()", input, size, benchmark::ticks([&]() noexcept -> void {
+                              unsigned char* const buffer = ::__read(path, &size);
+                              ::scan_frequencies(buffer, size, frequencies);
+                              ::free(buffer);
+                              benchmark::sink(frequencies);
+                          }, repeats));
+
+        for (const unsigned long long chunk_size : { 1LLU << 16, 1LLU << 20, FILEIO_CHUNK_SIZE }) {
+            char routine[64] {};
+            ::snprintf(routine, sizeof(routine), "streamreader (%llu KiB chunks)", chunk_size >> 10);
+            benchmark::report(routine, input, size, benchmark::ticks([&]() noexcept -> void {
+                                  ::streamreader_t   reader {};
+                                  unsigned long long nbytes {};
+                                  if (!::streamreader_open(&reader, path, chunk_size)) return;
+                                  ::memset(frequencies, 0U, sizeof(frequencies));
+                                  while (const unsigned char* const chunk = ::streamreader_next(&reader, &nbytes)) {
+                                      ::scan_frequencies(chunk, nbytes, partial);
+                                      for (unsigned s = 0; s < BYTECOUNT; ++s) frequencies[s] += partial[s];
+                                  }
+                                  ::streamreader_close(&reader);
+                                  benchmark::sink(frequencies);
+                              }, repeats));
+        }
+    };
+
+    for (const auto& path : benchmark::test_files) compare(path, path, 16);
+    if (replicate_corpus(512LLU << 20)) compare(corpus_path, "512 MiB corpus", 4);
+    ::remove(corpus_path);
+}
+
+BENCHMARK(fileio_write) {
+    long size {};
+    if (!replicate_corpus(256LLU << 20)) return;
+    unsigned char* const corpus = ::__read(corpus_path, &size);
+    ::remove(corpus_path);
+    if (!corpus) return;
+
+    // 64 KiB blocks in separate allocations, as the workers of a block parallel compressor would hand them over
+    std::vector<std::vector<unsigned char>> blocks {};
+    for (long offset = 0; offset < size; offset += 1LL << 16)
+        blocks.emplace_back(corpus + offset, corpus + std::min<long>(offset + (1LL << 16), size));
+    ::free(corpus);
+    std::vector<struct iovec> iovecs(blocks.size());
+
+    // the output lands in the page cache, so these are the costs of the copies and of the allocation of the file's blocks
+    benchmark::report("concatenate + __write()", "256 MiB in 64 KiB blocks", size, benchmark::ticks([&]() noexcept -> void {
+                          std::vector<unsigned char> buffer(size);
+                          unsigned long long         offset {};
+                          for (const auto& block : blocks) {
+                              ::memcpy(buffer.data() + offset, block.data(), block.size());
+                              offset += block.size();
+                          }
+                          ::__write(output_path, buffer.data(), size);
+                      }, 4));
+    for (const unsigned long long size_hint : { 0LLU, static_cast<unsigned long long>(size) }) {
+        benchmark::report(size_hint ? "filewriter_writev() (preallocated)" : "filewriter_writev()", "256 MiB in 64 KiB blocks", size,
+                          benchmark::ticks([&]() noexcept -> void {
+                              ::filewriter_t writer {};
+                              for (unsigned long long i = 0; i < blocks.size(); ++i) iovecs[i] = { blocks[i].data(), blocks[i].size() };
+                              if (!::filewriter_open(&writer, output_path, size_hint)) return;
+                              ::filewriter_writev(&writer, iovecs.data(), iovecs.size());
+                              ::filewriter_close(&writer);
+                          }, 4));
+    }
+    ::remove(output_path);
+}
+
+BENCHMARK(fileio_uring) {
+    // FILEIO_BENCH_GIB sets the size of the corpus, a few GB by default
+    const char* const        gib     = ::getenv("FILEIO_BENCH_GIB");
+    const unsigned long long nbytes  = (gib ? ::strtoull(gib, nullptr, 10) : 2) << 30;
+    const auto               corpus  = replicate_files(nbytes);
+    unsigned long long       ncopied = 0;
+    if (corpus.empty()) return;
+
+    std::vector<const char*> paths(corpus.size());
+    long                     size {};
+    for (unsigned long long i = 0; i < corpus.size(); ++i) paths[i] = corpus[i].c_str();
+    for (const auto* const path : paths) {
+        unsigned char* const buffer = ::__read(path, &size);
+        ::free(buffer);
+        ncopied += size;
+    }
+    char input[32] {};
+    ::snprintf(input, sizeof(input), "%zu files, %llu MiB", paths.size(), ncopied >> 20);
+
+    unsigned long long frequencies[BYTECOUNT] {};
+    unsigned long long partial[BYTECOUNT] {};
+
+    // the histogram stands in for the compression of each chunk, the cold runs evict the corpus from the page cache first
+    const auto evict = [&paths]() noexcept -> void {
+        for (const auto* const path : paths) {
+            const int fdesc = ::open(path, O_RDONLY);
+            ::posix_fadvise(fdesc, 0, 0, POSIX_FADV_DONTNEED);
+            ::close(fdesc);
+        }
+    };
+    const auto read_all = [&]() noexcept -> void {
+        for (const auto* const path : paths) {
+            unsigned char* const buffer = ::__read(path, &size);
+            if (size) ::scan_frequencies(buffer, size, partial);
+            ::free(buffer);
+            benchmark::sink(partial);
+        }
+    };
+    const auto batch_all = [&](const unsigned depth) noexcept -> void {
+        ::filebatch_t batch {};
+        ::filechunk_t chunk {};
+        if (!::filebatch_open(&batch, paths.data(), paths.size(), 1LLU << 20, depth)) return;
+        while (::filebatch_next(&batch, &chunk)) {
+            if (chunk.nbytes) ::scan_frequencies(chunk.buffer, chunk.nbytes, partial);
+            for (unsigned s = 0; s < BYTECOUNT; ++s) frequencies[s] += partial[s];
+        }
+        ::filebatch_close(&batch);
+        benchmark::sink(frequencies);
+    };
+
+    static constexpr const char* const routines[2][3] = {
+        { "__read() x files", "filebatch pread()", "filebatch io_uring" },
+        { "__read() x files (cold)", "filebatch pread() (cold)", "filebatch io_uring (cold)" }
+    };
+    for (const bool is_cold : { true, false }) {
+        const unsigned repeats = is_cold ? 2 : 4;
+        benchmark::report(routines[is_cold][0], input, ncopied, benchmark::ticks([&]() noexcept -> void {
+                              if (is_cold) evict();
+                              read_all();
+                          }, repeats));
+        benchmark::report(routines[is_cold][1], input, ncopied, benchmark::ticks([&]() noexcept -> void {
+                              if (is_cold) evict();
+                              batch_all(1);
+                          }, repeats));
+        benchmark::report(routines[is_cold][2], input, ncopied, benchmark::ticks([&]() noexcept -> void {
+                              if (is_cold) evict();
+                              batch_all(0);
+                          }, repeats));
+    }
+
+    // writes the first 512 MiB worth of the corpus back out, one file per buffer
+    std::vector<unsigned char*>     buffers {};
+    std::vector<unsigned long long> sizes {};
+    std::vector<std::string>        outputs {};
+    std::vector<const char*>        outpaths {};
+    unsigned long long              nwritten {};
+    for (unsigned long long i = 0; i < paths.size() && nwritten < (512LLU << 20); ++i) {
+        buffers.push_back(::__read(paths[i], &size));
+        sizes.push_back(size);
+        outputs.emplace_back("./files/output_" + std::to_string(i) + ".tmp");
+        nwritten += size;
+    }
+    for (const auto& output : outputs) outpaths.push_back(output.c_str());
+    for (const auto& path : corpus) ::remove(path.c_str());
+    ::snprintf(input, sizeof(input), "%zu files, %llu MiB", outpaths.size(), nwritten >> 20);
+
+    benchmark::report("__write() x files", input, nwritten, benchmark::ticks([&]() noexcept -> void {
+                          for (unsigned long long i = 0; i < outpaths.size(); ++i) ::__write(outpaths[i], buffers[i], sizes[i]);
+                      }, 4));
+    benchmark::report("__write_batch()", input, nwritten, benchmark::ticks([&]() noexcept -> void {
+                          ::__write_batch(outpaths.data(), buffers.data(), sizes.data(), outpaths.size());
+                      }, 4));
+
+    for (unsigned long long i = 0; i < outpaths.size(); ++i) {
+        ::remove(outpaths[i]);
+        ::free(buffers[i]);
+    }
+}
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <benchmark.hpp>
+
+extern "C" {
+#define restrict
+#include <huffman.h>
+#undef restrict
+}
+
+BENCHMARK(scan_frequencies) {
+    unsigned long long         frequencies[BYTECOUNT] {};
+    long                       nbytes {};
+    std::vector<unsigned char> zeroes(1LLU << 20); // a single long run, the worst case for a single table
+
+    benchmark::report("scan_frequencies_single", "1 MiB of zeroes", zeroes.size(), benchmark::ticks([&]() noexcept -> void {
+                          ::scan_frequencies_single(zeroes.data(), zeroes.size(), frequencies);
+                          benchmark::sink(frequencies);
+                      }));
+    benchmark::report("scan_frequencies", "1 MiB of zeroes", zeroes.size(), benchmark::ticks([&]() noexcept -> void {
+                          ::scan_frequencies(zeroes.data(), zeroes.size(), frequencies);
+                          benchmark::sink(frequencies);
+                      }));
+
+    for (const auto& path : benchmark::test_files) {
+        unsigned char* const buffer = ::__read(path, &nbytes);
+        if (!buffer) continue;
+
+        benchmark::report("scan_frequencies_single", path, nbytes, benchmark::ticks([&]() noexcept -> void {
+                              ::scan_frequencies_single(buffer, nbytes, frequencies);
+                              benchmark::sink(frequencies);
+                          }));
+        benchmark::report("scan_frequencies", path, nbytes, benchmark::ticks([&]() noexcept -> void {
+                              ::scan_frequencies(buffer, nbytes, frequencies);
+                              benchmark::sink(frequencies);
+                          }));
+
+        ::free(buffer);
+    }
+}
+
+BENCHMARK(scan_frequencies_parallel) {
+    unsigned long long         frequencies[BYTECOUNT] {};
+    long                       nbytes {};
+    std::vector<unsigned char> corpus {};
+
+    // the test files replicated until there is enough to keep every thread busy for a while
+    for (const auto& path : benchmark::test_files) {
+        unsigned char* const buffer = ::__read(path, &nbytes);
+        if (!buffer) continue;
+        corpus.insert(corpus.end(), buffer, buffer + nbytes);
+        ::free(buffer);
+    }
+    if (corpus.empty()) return;
+    while (corpus.size() < (256LLU << 20)) corpus.insert(corpus.end(), corpus.begin(), corpus.end());
+
+    benchmark::report("scan_frequencies", "replicated files", corpus.size(), benchmark::ticks([&]() noexcept -> void {
+                          ::scan_frequencies(corpus.data(), corpus.size(), frequencies);
+                          benchmark::sink(frequencies);
+                      }, 4));
+    for (const unsigned long long nthreads : { 1LLU, 2LLU, 4LLU, 8LLU }) {
+        char routine[64] {};
+        ::snprintf(routine, sizeof(routine), "scan_frequencies_parallel x%llu", nthreads);
+        benchmark::report(routine, "replicated files", corpus.size(), benchmark::ticks([&]() noexcept -> void {
+                              ::scan_frequencies_parallel(corpus.data(), corpus.size(), frequencies, nthreads);
+                              benchmark::sink(frequencies);
+                          }, 4));
+    }
+}
+
+BENCHMARK(build_huffman_tree) {
+    unsigned long long      frequencies[BYTECOUNT] {};
+    unsigned char           lengths[BYTECOUNT] {};
+    long                    nbytes {};
+    std::vector<::btnode_t> pqueue_buffer(GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY), bntree_buffer(GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+
+    // the histogram of each file's first block, the bytes reported are the bytes the tree will encode
+    for (const auto& path : benchmark::test_files) {
+        unsigned char* const buffer = ::__read(path, &nbytes);
+        if (!buffer) continue;
+        const auto blocksize = std::min<unsigned long long>(nbytes, HUFFMAN_BLOCK_SIZE);
+        ::scan_frequencies(buffer, blocksize, frequencies);
+        ::free(buffer);
+
+        benchmark::report("build_huffman_tree", path, blocksize, benchmark::ticks([&]() noexcept -> void {
+                              benchmark::sink(::build_huffman_tree(frequencies, pqueue_buffer.data(), bntree_buffer.data()));
+                          }, 256));
+        benchmark::report("build_huffman_tree_linear", path, blocksize, benchmark::ticks([&]() noexcept -> void {
+                              benchmark::sink(::build_huffman_tree_linear(frequencies, bntree_buffer.data()));
+                          }, 256));
+        benchmark::report("linear tree + build_code_lengths", path, blocksize, benchmark::ticks([&]() noexcept -> void {
+                              const auto huffman = ::build_huffman_tree_linear(frequencies, bntree_buffer.data());
+                              benchmark::sink(::build_code_lengths(&huffman, lengths));
+                              benchmark::sink(lengths);
+                          }, 256));
+        benchmark::report("build_code_lengths_inplace", path, blocksize, benchmark::ticks([&]() noexcept -> void {
+                              benchmark::sink(::build_code_lengths_inplace(frequencies, lengths));
+                              benchmark::sink(lengths);
+                          }, 256));
+    }
+}
+
+BENCHMARK(dpqueue) {
+    std::mt19937_64         rndengine { 0x5EED };
+    alignas(64) ::btnode_t  buffer[GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY] {};
+    std::vector<::btnode_t> nodes(GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY - HUFFMAN_PQUEUE_ARITY + 1);
+    ::btnode_t              popped {};
+
+    std::generate(nodes.begin(), nodes.end(), [&]() noexcept -> ::btnode_t { return { static_cast<unsigned>(rndengine() % 100'000), 0, 0 }; });
+
+    // fill then drain, with as many nodes as a Huffman tree over bytes has and with a full buffer, bytes are those of the nodes pushed
+    for (const unsigned long long count : { 2 * BYTECOUNT - 1, static_cast<unsigned long long>(nodes.size()) }) {
+        char input[32] {};
+        ::snprintf(input, sizeof(input), "%llu nodes", count);
+
+        benchmark::report("pqueue_t", input, count * sizeof(::btnode_t), benchmark::ticks([&]() noexcept -> void {
+                              auto prqueue = ::pqueue_init(buffer, GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+                              for (unsigned long long i = 0; i < count; ++i) ::pqueue_push(&prqueue, nodes[i]);
+                              while (::pqueue_pop(&prqueue, &popped)) benchmark::sink(popped);
+                          }, 256));
+        benchmark::report("dpqueue_t", input, count * sizeof(::btnode_t), benchmark::ticks([&]() noexcept -> void {
+                              auto prqueue = ::dpqueue_init(buffer, GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+                              for (unsigned long long i = 0; i < count; ++i) ::dpqueue_push(&prqueue, nodes[i]);
+                              while (::dpqueue_pop(&prqueue, &popped)) benchmark::sink(popped);
+                          }, 256));
+    }
+}
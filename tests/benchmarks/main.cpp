@@ -0,0 +1,14 @@
+#include <benchmark.hpp>
+
+// ./bench.out runs every benchmark, ./bench.out <substring>... only the ones whose names contain one of the substrings
+int main(const int argc, const char* const argv[]) {
+    for (const auto& [name, routine] : benchmark::registry()) {
+        bool is_selected = argc == 1;
+        for (int i = 1; i < argc; ++i) is_selected |= std::string_view { name }.find(argv[i]) != std::string_view::npos;
+        if (!is_selected) continue;
+
+        ::printf("[ %s ]\n", name);
+        routine();
+    }
+    return EXIT_SUCCESS;
+}
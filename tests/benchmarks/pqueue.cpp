@@ -0,0 +1,121 @@
+#include <random>
+#include <vector>
+
+#include <benchmark.hpp>
+#include <pqueue.hpp>
+#include <test.hpp>
+
+[[nodiscard]] static bool record_compare(const void* const child, const void* const parent) noexcept {
+    return *reinterpret_cast<const pqueue_stress_test::record*>(child) > *reinterpret_cast<const pqueue_stress_test::record*>(parent);
+}
+
+BENCHMARK(value_storage_pqueue) {
+    std::mt19937_64                         rndengine { 0x5EED };
+    std::vector<pqueue_stress_test::record> records(200'000);
+    pqueue_stress_test::record              popped {};
+    const unsigned long long                nbytes = records.size() * sizeof(pqueue_stress_test::record);
+
+    for (auto& record : records) record.unit_price = static_cast<float>(rndengine() % 1'000'000) / 100.0F;
+
+    // fill then drain, with the records the schedulers keep in these queues
+    benchmark::report("pqueue (a malloc per record)", "200K records", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          ::pqueue prqueue {};
+                          ::pqueue_init(&prqueue, record_compare);
+                          for (const auto& record : records) {
+                              auto* const copy = reinterpret_cast<pqueue_stress_test::record*>(::malloc(sizeof(pqueue_stress_test::record)));
+                              *copy            = record;
+                              ::pqueue_push(&prqueue, copy);
+                          }
+                          void* node {};
+                          while (::pqueue_pop(&prqueue, &node)) ::free(node);
+                      }, 4));
+    benchmark::report("vpqueue", "200K records", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          ::vpqueue prqueue {};
+                          ::vpqueue_init(&prqueue, sizeof(pqueue_stress_test::record), record_compare);
+                          for (const auto& record : records) ::vpqueue_push(&prqueue, &record);
+                          while (::vpqueue_pop(&prqueue, &popped)) benchmark::sink(popped);
+                          ::vpqueue_clean(&prqueue);
+                      }, 4));
+    benchmark::report("value_pqueue<record>", "200K records", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          value_pqueue<pqueue_stress_test::record> prqueue {};
+                          for (const auto& record : records) prqueue.push(record);
+                          while (prqueue.pop(popped)) benchmark::sink(popped);
+                      }, 4));
+}
+
+[[nodiscard]] static bool key_compare(const void* const child, const void* const parent) noexcept {
+    return reinterpret_cast<uintptr_t>(child) > reinterpret_cast<uintptr_t>(parent); // the keys are stored in place of the pointers
+}
+
+[[nodiscard]] static bool key_value_compare(const void* const child, const void* const parent) noexcept {
+    return *reinterpret_cast<const unsigned long long*>(child) > *reinterpret_cast<const unsigned long long*>(parent);
+}
+
+BENCHMARK(pqueue_growth) {
+    std::mt19937_64                 rndengine { 0x5EED };
+    std::vector<unsigned long long> keys(10'000'000);
+    unsigned long long              popped {};
+    const unsigned long long        nbytes = keys.size() * sizeof(unsigned long long);
+
+    for (auto& key : keys) key = rndengine() | 1LLU; // never a nullptr
+
+    // fill then drain 10M elements, once letting the queue grow from DEFAULT_PQUEUE_CAPACITY and once after a reserve
+    for (const bool reserve : { false, true }) {
+        benchmark::report(reserve ? "pqueue (reserved)" : "pqueue (growing)", "10M", nbytes, benchmark::ticks([&]() noexcept -> void {
+                              ::pqueue prqueue {};
+                              void*    node {};
+                              ::pqueue_init(&prqueue, key_compare);
+                              if (reserve) ::pqueue_reserve(&prqueue, keys.size());
+                              for (const auto& key : keys) ::pqueue_push(&prqueue, reinterpret_cast<void*>(key));
+                              while (::pqueue_pop(&prqueue, &node)) benchmark::sink(node); // the last pop cleans the queue
+                          }, 1));
+        benchmark::report(reserve ? "vpqueue (reserved)" : "vpqueue (growing)", "10M", nbytes, benchmark::ticks([&]() noexcept -> void {
+                              value_pqueue<unsigned long long> prqueue {};
+                              if (reserve) prqueue.reserve(keys.size());
+                              for (const auto& key : keys) prqueue.push(key);
+                              while (prqueue.pop(popped)) benchmark::sink(popped);
+                          }, 1));
+    }
+}
+
+BENCHMARK(pqueue_from_array) {
+    std::mt19937_64                 rndengine { 0x5EED };
+    std::vector<unsigned long long> keys(1'000'000);
+    const unsigned long long        nbytes = keys.size() * sizeof(unsigned long long);
+
+    for (auto& key : keys) key = rndengine() | 1LLU;
+
+    // loading the queue only, the pqueue_t s are drained by setting their count to 0 as pqueue_clean() would free() the keys
+    benchmark::report("pqueue_push() x 1M", "1M keys", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          ::pqueue prqueue {};
+                          ::pqueue_init(&prqueue, key_compare);
+                          for (const auto& key : keys) ::pqueue_push(&prqueue, reinterpret_cast<void*>(key));
+                          prqueue.count = 0;
+                          ::pqueue_clean(&prqueue);
+                      }, 4));
+    benchmark::report("pqueue_from_array()", "1M keys", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          ::pqueue prqueue {};
+                          ::pqueue_from_array(&prqueue, reinterpret_cast<void* const*>(keys.data()), keys.size(), key_compare);
+                          prqueue.count = 0;
+                          ::pqueue_clean(&prqueue);
+                      }, 4));
+    benchmark::report("vpqueue_push() x 1M", "1M keys", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          ::vpqueue prqueue {};
+                          ::vpqueue_init(&prqueue, sizeof(unsigned long long), key_value_compare);
+                          for (const auto& key : keys) ::vpqueue_push(&prqueue, &key);
+                          ::vpqueue_clean(&prqueue);
+                      }, 4));
+    benchmark::report("vpqueue_from_array()", "1M keys", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          ::vpqueue prqueue {};
+                          ::vpqueue_from_array(&prqueue, keys.data(), keys.size(), sizeof(unsigned long long), key_value_compare);
+                          ::vpqueue_clean(&prqueue);
+                      }, 4));
+    benchmark::report("value_pqueue::push() x 1M", "1M keys", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          value_pqueue<unsigned long long> prqueue {};
+                          for (const auto& key : keys) prqueue.push(key);
+                      }, 4));
+    benchmark::report("value_pqueue::push_bulk()", "1M keys", nbytes, benchmark::ticks([&]() noexcept -> void {
+                          value_pqueue<unsigned long long> prqueue {};
+                          prqueue.push_bulk(keys.data(), keys.size());
+                      }, 4));
+}
@@ -0,0 +1,195 @@
+#include <numeric>
+#include <vector>
+
+#include <test.hpp>
+
+extern "C" {
+#define restrict
+#include <bintree.h>
+#undef restrict
+}
+
+// builds a complete binary tree of count nodes level by level, nodes[i] ends up holding the node with the i th datum
+static void build_complete_tree(bntree* const tree, std::vector<unsigned long long>& data, std::vector<btnode*>& nodes) {
+    ASSERT_TRUE(::bntree_insert(tree, nullptr, ROOT, &data[0]));
+    nodes[0] = tree->root;
+    for (size_t i = 1; i < data.size(); ++i) {
+        btnode* const parent = nodes[(i - 1) / 2];
+        ASSERT_TRUE(::bntree_insert(tree, parent, i % 2 ? LEFT : RIGHT, &data[i]));
+        nodes[i] = i % 2 ? parent->left : parent->right;
+    }
+}
+
+TEST(bintree, malloced_nodes) {
+    std::vector<unsigned long long> data(1000);
+    std::vector<btnode*>            nodes(data.size());
+    ::bntree                        tree {};
+    ::bntree_init(&tree, nullptr);
+
+    build_complete_tree(&tree, data, nodes);
+    EXPECT_EQ(tree.node_count, data.size());
+    EXPECT_FALSE(::bntree_insert(&tree, nullptr, ROOT, &data[0])); // the root is taken
+    EXPECT_FALSE(::bntree_insert(&tree, nodes[0], LEFT, &data[0])); // so is its left arm
+
+    EXPECT_TRUE(::bntree_remove(&tree, nodes[0], LEFT)); // takes the whole left subtree along
+    EXPECT_FALSE(nodes[0]->left);
+    EXPECT_LT(tree.node_count, data.size() / 2 + 1);
+    ::bntree_release(&tree);
+    EXPECT_FALSE(tree.node_count);
+    EXPECT_FALSE(tree.root);
+}
+
+TEST(bintree, arena) {
+    std::vector<unsigned long long> data(5000);
+    std::vector<btnode*>            nodes(data.size());
+    ::bnarena                       arena {};
+    ::bntree                        tree {};
+    ::bnarena_init(&arena, 1024);
+    ::bntree_init(&tree, &arena);
+    EXPECT_FALSE(arena.chunks); // nothing is allocated up front
+
+    build_complete_tree(&tree, data, nodes);
+    EXPECT_EQ(tree.node_count, data.size());
+    EXPECT_EQ(nodes[1], nodes[0] + 1); // bumped back to back
+    EXPECT_EQ(nodes[1000], nodes[999] + 1);
+    EXPECT_TRUE(arena.chunks->next); // 5000 nodes take 5 chunks of 1024
+    for (size_t i = 0; i < data.size(); ++i) EXPECT_EQ(nodes[i]->data, &data[i]);
+
+    // removed nodes get handed out again before the chunk is bumped
+    btnode* const leaf   = nodes[data.size() - 1]; // an odd index, so a left child
+    btnode* const parent = nodes[(data.size() - 2) / 2];
+    const auto    used   = arena.used;
+    EXPECT_TRUE(::bntree_remove(&tree, parent, LEFT));
+    EXPECT_EQ(tree.node_count, data.size() - 1);
+    EXPECT_TRUE(::bntree_insert(&tree, parent, LEFT, &data[0]));
+    EXPECT_EQ(parent->left, leaf);
+    EXPECT_EQ(arena.used, used);
+
+    // releasing the tree keeps only the current chunk
+    ::bntree_release(&tree);
+    EXPECT_FALSE(tree.node_count);
+    EXPECT_FALSE(tree.root);
+    EXPECT_TRUE(arena.chunks);
+    EXPECT_FALSE(arena.chunks->next);
+    EXPECT_FALSE(arena.used);
+
+    build_complete_tree(&tree, data, nodes);
+    EXPECT_EQ(tree.node_count, data.size());
+    ::bnarena_release(&arena);
+    EXPECT_FALSE(arena.chunks);
+}
+
+TEST(bintree, merge) {
+    unsigned long long data[3] {};
+    ::bnarena          arena {};
+    ::bntree           left {}, right {}; // NOLINT(readability-isolate-declaration)
+    ::bnarena_init(&arena, 0);
+    EXPECT_EQ(arena.chunk_capacity, BNARENA_CHUNK_NODES);
+
+    ::bntree_init(&left, &arena);
+    ::bntree_init(&right, &arena);
+    ASSERT_TRUE(::bntree_insert(&left, nullptr, ROOT, &data[0]));
+    ASSERT_TRUE(::bntree_insert(&right, nullptr, ROOT, &data[1]));
+
+    auto merged = ::bntree_merge(&left, &right, &data[2]);
+    EXPECT_EQ(merged.node_count, 3LLU);
+    EXPECT_EQ(merged.arena, &arena);
+    EXPECT_EQ(merged.root->data, &data[2]);
+    EXPECT_EQ(merged.root->left->data, &data[0]);
+    EXPECT_EQ(merged.root->right->data, &data[1]);
+    EXPECT_FALSE(left.root);
+    EXPECT_FALSE(right.node_count);
+
+    ::bntree_release(&merged);
+    ::bnarena_release(&arena);
+}
+
+// appends the datum of every node it visits to the std::vector<unsigned long long> passed as the context
+static void collect(btnode* const node, void* const context) noexcept {
+    reinterpret_cast<std::vector<unsigned long long>*>(context)->push_back(*reinterpret_cast<const unsigned long long*>(node->data));
+}
+
+TEST(bintree, traversals) {
+    std::vector<unsigned long long> data(10), visited {};
+    std::vector<btnode*>            nodes(data.size());
+    btnode*                         stack[10] {};
+    ::bntree                        tree {};
+    std::iota(data.begin(), data.end(), 0);
+    ::bntree_init(&tree, nullptr);
+    build_complete_tree(&tree, data, nodes);
+
+    /*                  0
+                     /     \
+                    1       2
+                  /   \    /  \
+                 3     4  5    6
+                / \   /
+               7   8 9                  */
+
+    EXPECT_TRUE(::bntree_preorder(&tree, stack, std::size(stack), collect, &visited));
+    EXPECT_EQ(visited, (std::vector<unsigned long long> { 0, 1, 3, 7, 8, 4, 9, 2, 5, 6 }));
+    visited.clear();
+    EXPECT_TRUE(::bntree_inorder(&tree, stack, std::size(stack), collect, &visited));
+    EXPECT_EQ(visited, (std::vector<unsigned long long> { 7, 3, 8, 1, 9, 4, 0, 5, 2, 6 }));
+    visited.clear();
+    EXPECT_TRUE(::bntree_postorder(&tree, stack, std::size(stack), collect, &visited));
+    EXPECT_EQ(visited, (std::vector<unsigned long long> { 7, 8, 3, 9, 4, 1, 5, 6, 2, 0 }));
+    visited.clear();
+    EXPECT_TRUE(::bntree_levelorder(&tree, stack, std::size(stack), collect, &visited));
+    EXPECT_EQ(visited, (std::vector<unsigned long long> { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9 }));
+
+    // a stack as deep as the tree is enough for the in and post-order traversals, the level order one needs more than the widest
+    // level as the next level starts filling up before the current one is done, 5 entries here
+    visited.clear();
+    EXPECT_TRUE(::bntree_inorder(&tree, stack, 4, collect, &visited));
+    EXPECT_TRUE(::bntree_postorder(&tree, stack, 4, collect, &visited));
+    EXPECT_FALSE(::bntree_inorder(&tree, stack, 3, collect, &visited));
+    EXPECT_FALSE(::bntree_postorder(&tree, stack, 3, collect, &visited));
+    EXPECT_FALSE(::bntree_preorder(&tree, stack, 0, collect, &visited));
+    EXPECT_TRUE(::bntree_levelorder(&tree, stack, 5, collect, &visited));
+    EXPECT_FALSE(::bntree_levelorder(&tree, stack, 4, collect, &visited));
+
+    ::bntree_release(&tree);
+}
+
+TEST(bintree, degenerate_teardown) {
+    // a million nodes deep, which would take a recursive teardown a million frames
+    std::vector<unsigned long long> data(1'000'000), visited {};
+    ::bntree                        tree {};
+    btnode*                         node {};
+    btnode*                         stack[2] {};
+    ::bntree_init(&tree, nullptr);
+
+    ASSERT_TRUE(::bntree_insert(&tree, nullptr, ROOT, &data[0]));
+    node = tree.root;
+    for (size_t i = 1; i < data.size(); ++i) {
+        ASSERT_TRUE(::bntree_insert(&tree, node, i % 3 ? LEFT : RIGHT, &data[i]));
+        node = node->left ? node->left : node->right;
+    }
+
+    EXPECT_TRUE(::bntree_preorder(&tree, stack, std::size(stack), collect, &visited)); // a chain never has more than one node pending
+    EXPECT_EQ(visited.size(), data.size());
+
+    EXPECT_TRUE(::bntree_remove(&tree, tree.root->left, LEFT)); // takes everything below the third node
+    EXPECT_EQ(tree.node_count, 2LLU);
+    ::bntree_release(&tree);
+    EXPECT_FALSE(tree.node_count);
+}
+
+TEST(bintree, teardown) {
+    std::vector<unsigned long long> data(1000);
+    std::vector<btnode*>            nodes(data.size());
+    btnode*                         stack[3] {};
+    ::bntree                        tree {};
+    ::bntree_init(&tree, nullptr);
+
+    // a stack too shallow for the tree, the subtrees that do not fit get rotated down instead
+    build_complete_tree(&tree, data, nodes);
+    ::bntree_teardown(&tree, stack, std::size(stack));
+    EXPECT_FALSE(tree.root);
+    EXPECT_FALSE(tree.node_count);
+
+    build_complete_tree(&tree, data, nodes);
+    ::bntree_teardown(&tree, nullptr, 0);
+    EXPECT_FALSE(tree.root);
+}
@@ -1,3 +1,6 @@
+#include <random>
+#include <vector>
+
 #include <test.hpp>
 
 extern "C" {
@@ -282,3 +285,176 @@ TEST(bitops, xorbit) {
         EXPECT_EQ(::getbit(mutablestream, i), !(::getbit(bitstream, i) == ::getbit(xorbitstream, i)));
     }
 }
+
+// the widths put_bits() and peek_bits() move in the tests below, cycling through every width they accept
+[[nodiscard]] static constexpr unsigned bitio_width(const unsigned long long step) noexcept { return 1 + step % BITIO_MAX_BITS; }
+
+// the next nbits bits of binstr, starting at offset, as an integer
+[[nodiscard]] static constexpr unsigned long long binstr_value(const unsigned long long offset, const unsigned nbits) noexcept {
+    unsigned long long value {};
+    for (unsigned i = 0; i < nbits; ++i) value = (value << 1) | static_cast<unsigned long long>(binstr[offset + i] - 48);
+    return value;
+}
+
+TEST(bitops, bitwriter) {
+    unsigned char      outbuff[BITSTREAM_BYTE_COUNT + sizeof(unsigned long long)] {}; // 8 bytes of slack for the flushes
+    ::bitwriter_t      writer {};
+    unsigned long long offset {}, step {};
+
+    ::bitwriter_init(&writer, outbuff);
+    for (unsigned nbits = bitio_width(step); offset + nbits <= BITSTREAM_BIT_COUNT; nbits = bitio_width(++step)) {
+        ::put_bits(&writer, nbits, binstr_value(offset, nbits));
+        offset += nbits;
+    }
+    for (; offset < BITSTREAM_BIT_COUNT; ++offset) ::put_bits(&writer, 1, binstr_value(offset, 1));
+
+    EXPECT_EQ(::bitwriter_finish(&writer), BITSTREAM_BYTE_COUNT);
+    EXPECT_EQ(::memcmp(outbuff, bitstream, BITSTREAM_BYTE_COUNT), 0);
+
+    // a partial last byte is padded with 0 bits
+    ::bitwriter_init(&writer, outbuff);
+    ::put_bits(&writer, 3, 0b101);
+    ::append_bits(&writer, 12, 0b1111'0000'1111);
+    ::append_bits(&writer, 2, 0b11);
+    ::bitwriter_flush(&writer);
+    EXPECT_EQ(writer.nbits, 1U);
+    EXPECT_EQ(::bitwriter_finish(&writer), 3LLU);
+    EXPECT_EQ(outbuff[0], 0b1011'1110);
+    EXPECT_EQ(outbuff[1], 0b0001'1111);
+    EXPECT_EQ(outbuff[2], 0b1000'0000);
+}
+
+TEST(bitops, bitreader) {
+    ::bitreader_t      reader {};
+    unsigned long long offset {}, step {};
+
+    ::bitreader_init(&reader, bitstream, BITSTREAM_BYTE_COUNT);
+    for (unsigned nbits = bitio_width(step); offset + nbits <= BITSTREAM_BIT_COUNT; nbits = bitio_width(++step)) {
+        ::bitreader_refill(&reader); // the last few reads go through the padded tail
+        EXPECT_EQ(::peek_bits(&reader, nbits), binstr_value(offset, nbits));
+        ::consume_bits(&reader, nbits);
+        offset += nbits;
+        EXPECT_EQ(reader.bitpos, offset);
+    }
+    EXPECT_FALSE(::bitreader_is_overrun(&reader));
+
+    // bits past the end of the bitstream read as 0s
+    ::bitreader_refill(&reader);
+    EXPECT_EQ(::peek_bits(&reader, BITSTREAM_BIT_COUNT - offset + 8), binstr_value(offset, BITSTREAM_BIT_COUNT - offset) << 8);
+    ::consume_bits(&reader, BITSTREAM_BIT_COUNT - offset + 1);
+    EXPECT_TRUE(::bitreader_is_overrun(&reader));
+
+    // several consumes between two refills, as long as the reader has a word left, the window holds at least 57 bits
+    ::bitreader_init(&reader, bitstream, BITSTREAM_BYTE_COUNT);
+    for (offset = 0; ::bitreader_has_word(&reader);) {
+        ::bitreader_refill_fast(&reader);
+        for (const unsigned nbits : { 5U, 17U, 1U, 30U, 4U }) {
+            EXPECT_EQ(::peek_bits(&reader, nbits), binstr_value(offset, nbits));
+            ::consume_bits(&reader, nbits);
+            offset += nbits;
+        }
+    }
+    EXPECT_GT(offset + 8 * sizeof(unsigned long long), BITSTREAM_BIT_COUNT);
+}
+
+TEST(bitops, bitio_roundtrip) {
+    std::mt19937_64                 rndengine { 0x5EED };
+    std::vector<unsigned>           widths(10'000);
+    std::vector<unsigned long long> values(widths.size());
+    unsigned long long              nbits {};
+
+    for (size_t i = 0; i < widths.size(); ++i) {
+        widths[i]  = 1 + rndengine() % BITIO_MAX_BITS;
+        values[i]  = rndengine() >> (64 - widths[i]);
+        nbits     += widths[i];
+    }
+
+    std::vector<unsigned char> buffer((nbits + 7) / 8 + sizeof(unsigned long long));
+    ::bitwriter_t              writer {};
+    ::bitreader_t              reader {};
+
+    ::bitwriter_init(&writer, buffer.data());
+    for (size_t i = 0; i < widths.size(); ++i) ::put_bits(&writer, widths[i], values[i]);
+    ASSERT_EQ(::bitwriter_finish(&writer), (nbits + 7) / 8);
+
+    ::bitreader_init(&reader, buffer.data(), (nbits + 7) / 8);
+    for (size_t i = 0; i < widths.size(); ++i) {
+        ::bitreader_refill(&reader);
+        EXPECT_EQ(::peek_bits(&reader, widths[i]), values[i]);
+        ::consume_bits(&reader, widths[i]);
+    }
+    EXPECT_EQ(reader.bitpos, nbits);
+    EXPECT_FALSE(::bitreader_is_overrun(&reader));
+}
+
+// bitwise reference for the range operations, one getbit() per bit
+[[nodiscard]] static unsigned long long popcount_reference(
+    const unsigned char* const buffer, const unsigned long long offset, const unsigned long long count
+) {
+    unsigned long long total {};
+    for (unsigned long long i = offset; i < offset + count; ++i) total += ::getbit(buffer, i);
+    return total;
+}
+
+// offsets and counts that start and end on every bit position of a byte, including counts that stay inside a single byte and
+// ones long enough to cover a few whole vectors
+static constexpr unsigned long long range_offsets[] = { 0, 1, 3, 7, 8, 13, 64, 100, 511 };
+static constexpr unsigned long long range_counts[]  = { 0, 1, 2, 5, 7, 8, 9, 63, 64, 65, 255, 513, 1027, 4096, 7000 };
+
+TEST(bitops, xorbits_andbits) {
+    unsigned char expected[BITSTREAM_BYTE_COUNT] {};
+
+    for (const auto& offset : range_offsets) {
+        for (const auto& count : range_counts) {
+            if (offset + count > BITSTREAM_BIT_COUNT) continue;
+
+            ::memset(mutablestream, 0xA5, sizeof(mutablestream)); // the bits outside the range must keep this pattern
+            ::memset(expected, 0xA5, sizeof(expected));
+            ::xorbits(bitstream, xorbitstream, mutablestream, offset, count);
+            for (unsigned long long i = offset; i < offset + count; ++i) ::xorbit(bitstream, xorbitstream, expected, i);
+            EXPECT_EQ(::memcmp(mutablestream, expected, BITSTREAM_BYTE_COUNT), 0) << "offset " << offset << " count " << count;
+
+            ::memset(mutablestream, 0x5A, sizeof(mutablestream));
+            ::memset(expected, 0x5A, sizeof(expected));
+            ::andbits(bitstream, xorbitstream, mutablestream, offset, count);
+            for (unsigned long long i = offset; i < offset + count; ++i)
+                ::setbit(expected, i, ::getbit(bitstream, i) && ::getbit(xorbitstream, i));
+            EXPECT_EQ(::memcmp(mutablestream, expected, BITSTREAM_BYTE_COUNT), 0) << "offset " << offset << " count " << count;
+        }
+    }
+}
+
+TEST(bitops, copybits) {
+    unsigned char expected[BITSTREAM_BYTE_COUNT] {};
+
+    for (const auto& inoffset : range_offsets) {
+        for (const auto& outoffset : range_offsets) {
+            for (const auto& count : range_counts) {
+                if (inoffset + count > BITSTREAM_BIT_COUNT || outoffset + count > BITSTREAM_BIT_COUNT) continue;
+
+                ::memset(mutablestream, 0xC3, sizeof(mutablestream));
+                ::memset(expected, 0xC3, sizeof(expected));
+                ::copybits(bitstream, inoffset, mutablestream, outoffset, count);
+                for (unsigned long long i = 0; i < count; ++i) ::setbit(expected, outoffset + i, ::getbit(bitstream, inoffset + i));
+                EXPECT_EQ(::memcmp(mutablestream, expected, BITSTREAM_BYTE_COUNT), 0)
+                    << "inoffset " << inoffset << " outoffset " << outoffset << " count " << count;
+            }
+        }
+    }
+
+    // the shifted copy must not read past the last byte that holds a bit of the range, the vector is sized to the range exactly
+    std::vector<unsigned char> tight(bitstream + 1, bitstream + 101);
+    ::copybits(tight.data(), 3, mutablestream, 0, 100 * 8 - 3);
+    for (unsigned long long i = 0; i < 100 * 8 - 3; ++i) EXPECT_EQ(::getbit(mutablestream, i), ::getbit(bitstream, 8 + 3 + i));
+}
+
+TEST(bitops, popcount_range) {
+    for (const auto& offset : range_offsets) {
+        for (const auto& count : range_counts) {
+            if (offset + count > BITSTREAM_BIT_COUNT) continue;
+            EXPECT_EQ(::popcount_range(bitstream, offset, count), popcount_reference(bitstream, offset, count))
+                << "offset " << offset << " count " << count;
+        }
+    }
+    EXPECT_EQ(::popcount_range(bitstream, 0, BITSTREAM_BIT_COUNT), popcount_reference(bitstream, 0, BITSTREAM_BIT_COUNT));
+}
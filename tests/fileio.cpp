@@ -1,5 +1,8 @@
 #include <algorithm>
 #include <random>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include <test.hpp>
 
@@ -68,3 +71,351 @@ TEST(fileio, __write) {
     EXPECT_FALSE(::remove(R"(./files/temp01.dat)")); // ::remove() returns 0 upon successful deletion
     EXPECT_FALSE(::remove(R"(./files/temp02.dat)"));
 }
+
+TEST(fileio, __map) {
+    long               size {};
+    unsigned long long nbytes {};
+
+    for (const auto* const path : { R"(./files/bronze.jpg)", R"(./files/mobydick.txt)", R"(./files/table.csv)" }) {
+        unsigned char* const       buffer  = ::__read(path, &size);
+        const unsigned char* const mapping = ::__map(path, &nbytes);
+        ASSERT_TRUE(buffer);
+        ASSERT_TRUE(mapping);
+        EXPECT_EQ(nbytes, static_cast<unsigned long long>(size));
+        EXPECT_TRUE(std::equal(buffer, buffer + size, mapping));
+        EXPECT_TRUE(::__unmap(mapping, nbytes));
+        ::free(buffer);
+    }
+
+    // empty files map to a zero length view rather than a failure
+    EXPECT_TRUE(::__write(R"(./files/temp03.dat)", reinterpret_cast<const unsigned char*>(""), 0));
+    const unsigned char* const empty = ::__map(R"(./files/temp03.dat)", &nbytes);
+    EXPECT_TRUE(empty);
+    EXPECT_EQ(nbytes, 0LLU);
+    EXPECT_TRUE(::__unmap(empty, nbytes));
+    EXPECT_FALSE(::remove(R"(./files/temp03.dat)"));
+
+    EXPECT_FALSE(::__map(R"(./files/nonexistent.dat)", &nbytes));
+    EXPECT_EQ(nbytes, 0LLU);
+}
+
+// collects a file through a streamreader_t, every chunk but the last must be exactly chunk_size bytes long
+[[nodiscard]] static std::vector<unsigned char> stream_file(const char* const path, const unsigned long long chunk_size, bool& is_ok) {
+    ::streamreader_t           reader {};
+    std::vector<unsigned char> contents {};
+    unsigned long long         nbytes {};
+    bool                       is_short {}; // has a chunk shorter than chunk_size been handed out already
+
+    is_ok = ::streamreader_open(&reader, path, chunk_size);
+    if (!is_ok) return contents;
+    while (const unsigned char* const chunk = ::streamreader_next(&reader, &nbytes)) {
+        EXPECT_FALSE(is_short);
+        EXPECT_LE(nbytes, reader.chunk_size);
+        is_short = nbytes < reader.chunk_size;
+        contents.insert(contents.end(), chunk, chunk + nbytes);
+    }
+    EXPECT_EQ(nbytes, 0LLU);
+    is_ok = ::streamreader_close(&reader);
+    return contents;
+}
+
+TEST(fileio, streamreader) {
+    long size {};
+    bool is_ok {};
+
+    for (const auto* const path : { R"(./files/bronze.jpg)", R"(./files/mobydick.txt)", R"(./files/synth.bin)" }) {
+        unsigned char* const buffer = ::__read(path, &size);
+        ASSERT_TRUE(buffer);
+        // chunk sizes that leave a short last chunk, one that divides synth.bin's 2'560'000 bytes, one larger than every file
+        // and the default
+        for (const unsigned long long chunk_size : { 4'093LLU, 1'024LLU, 65'536LLU, 1LLU << 23, 0LLU }) {
+            const auto contents = stream_file(path, chunk_size, is_ok);
+            EXPECT_TRUE(is_ok);
+            EXPECT_EQ(std::ssize(contents), size);
+            EXPECT_TRUE(std::equal(contents.cbegin(), contents.cend(), buffer));
+        }
+        ::free(buffer);
+    }
+
+    // an empty file yields no chunks
+    EXPECT_TRUE(::__write(R"(./files/temp04.dat)", reinterpret_cast<const unsigned char*>(""), 0));
+    EXPECT_TRUE(stream_file(R"(./files/temp04.dat)", 4'096, is_ok).empty());
+    EXPECT_TRUE(is_ok);
+    EXPECT_FALSE(::remove(R"(./files/temp04.dat)"));
+
+    ::streamreader_t reader {};
+    EXPECT_FALSE(::streamreader_open(&reader, R"(./files/nonexistent.dat)", 4'096));
+
+    // closing before the end of the file must stop the read ahead thread, which may be blocked on a full chunk
+    unsigned long long nbytes {};
+    ASSERT_TRUE(::streamreader_open(&reader, R"(./files/mobydick.txt)", 1'024));
+    EXPECT_TRUE(::streamreader_next(&reader, &nbytes));
+    EXPECT_EQ(nbytes, 1'024LLU);
+    EXPECT_TRUE(::streamreader_close(&reader));
+}
+
+TEST(fileio, __read_fully) {
+    std::vector<unsigned char> buffer(100'000);
+    std::vector<unsigned char> received(buffer.size() + 1); // one byte more than will ever be written
+    std::mt19937_64            rndengine { std::random_device {}() };
+    int                        pipefds[2] {};
+
+    std::generate(buffer.begin(), buffer.end(), [&rndengine]() noexcept -> auto { return static_cast<unsigned char>(rndengine()); });
+    ASSERT_FALSE(::pipe(pipefds));
+
+    // a pipe fed in small pieces hands out a few bytes per read(), a single read() would come back short
+    std::thread writer { [&buffer, &pipefds]() noexcept -> void {
+        for (unsigned long long offset = 0; offset < buffer.size(); offset += 777)
+            EXPECT_NE(::write(pipefds[1], buffer.data() + offset, std::min<unsigned long long>(777, buffer.size() - offset)), -1);
+        ::close(pipefds[1]);
+    } };
+    EXPECT_EQ(::__read_fully(pipefds[0], received.data(), received.size()), std::ssize(buffer)); // stops at the end of the stream
+    writer.join();
+    ::close(pipefds[0]);
+    EXPECT_TRUE(std::equal(buffer.cbegin(), buffer.cend(), received.cbegin()));
+
+    EXPECT_EQ(::__read_fully(-1, received.data(), received.size()), -1);
+}
+
+TEST(fileio, __write_truncates) {
+    std::vector<unsigned char> buffer(1'000'000, 0xAA);
+    long                       fsize {};
+
+    // rewriting a file with fewer bytes must not leave the tail of the previous contents behind
+    EXPECT_TRUE(::__write(R"(./files/temp05.dat)", buffer.data(), buffer.size()));
+    std::fill(buffer.begin(), buffer.end(), 0x55);
+    EXPECT_TRUE(::__write(R"(./files/temp05.dat)", buffer.data(), buffer.size() / 3));
+    unsigned char* const fbuffer = ::__read(R"(./files/temp05.dat)", &fsize);
+    ASSERT_TRUE(fbuffer);
+    EXPECT_EQ(fsize, std::ssize(buffer) / 3);
+    EXPECT_TRUE(std::equal(fbuffer, fbuffer + fsize, buffer.cbegin()));
+    ::free(fbuffer);
+    EXPECT_FALSE(::remove(R"(./files/temp05.dat)"));
+}
+
+TEST(fileio, filewriter) {
+    std::vector<unsigned char> buffer(3'000'000);
+    std::mt19937_64            rndengine { std::random_device {}() };
+    std::vector<struct iovec>  iovecs {};
+    ::filewriter_t             writer {};
+    long                       fsize {};
+
+    std::generate(buffer.begin(), buffer.end(), [&rndengine]() noexcept -> auto { return static_cast<unsigned char>(rndengine()); });
+
+    // a size hint below, at and above the bytes that get written, 0 skips the preallocation, the file must always come out exactly
+    // as long as the bytes written
+    for (const unsigned long long size_hint : { 0LLU, 1'000'000LLU, 3'000'000LLU, 8'000'000LLU }) {
+        ASSERT_TRUE(::filewriter_open(&writer, R"(./files/temp06.dat)", size_hint));
+        EXPECT_TRUE(::filewriter_write(&writer, buffer.data(), 100'000)); // a plain write followed by a batch of iovecs
+
+        // more iovecs than a single writev() takes, of random lengths and a few empty ones
+        iovecs.clear();
+        for (unsigned long long offset = 100'000; offset < buffer.size();) {
+            const unsigned long long length = std::min<unsigned long long>(rndengine() % 1'500, buffer.size() - offset);
+            iovecs.push_back({ buffer.data() + offset, length });
+            offset += length;
+        }
+        EXPECT_GT(iovecs.size(), static_cast<size_t>(IOV_MAX));
+        EXPECT_TRUE(::filewriter_writev(&writer, iovecs.data(), iovecs.size()));
+        EXPECT_TRUE(std::all_of(iovecs.cbegin(), iovecs.cend(), [](const struct iovec& iovec) noexcept -> bool { return !iovec.iov_len; }));
+        EXPECT_EQ(writer.nbytes, buffer.size());
+        EXPECT_TRUE(::filewriter_close(&writer));
+
+        unsigned char* const fbuffer = ::__read(R"(./files/temp06.dat)", &fsize);
+        ASSERT_TRUE(fbuffer);
+        EXPECT_EQ(fsize, std::ssize(buffer));
+        EXPECT_TRUE(std::equal(buffer.cbegin(), buffer.cend(), fbuffer));
+        ::free(fbuffer);
+    }
+
+    // reopening truncates
+    ASSERT_TRUE(::filewriter_open(&writer, R"(./files/temp06.dat)", 0));
+    EXPECT_TRUE(::filewriter_close(&writer));
+    unsigned long long nbytes {};
+    EXPECT_TRUE(::__unmap(::__map(R"(./files/temp06.dat)", &nbytes), nbytes));
+    EXPECT_EQ(nbytes, 0LLU);
+    EXPECT_FALSE(::remove(R"(./files/temp06.dat)"));
+
+    EXPECT_FALSE(::filewriter_open(&writer, R"(./nonexistent/temp06.dat)", 0));
+}
+
+TEST(fileio, __writev_fully) {
+    std::vector<unsigned char> buffer(1'000'000);
+    std::vector<unsigned char> received(buffer.size());
+    std::mt19937_64            rndengine { std::random_device {}() };
+    int                        pipefds[2] {};
+
+    std::generate(buffer.begin(), buffer.end(), [&rndengine]() noexcept -> auto { return static_cast<unsigned char>(rndengine()); });
+    ASSERT_FALSE(::pipe(pipefds));
+
+    // a non blocking pipe takes at most its 64 KiB capacity per writev(), so the iovecs get written out in many partial writes
+    ASSERT_NE(::fcntl(pipefds[1], F_SETFL, O_NONBLOCK), -1);
+    std::thread reader { [&received, &pipefds]() noexcept -> void {
+        EXPECT_EQ(::__read_fully(pipefds[0], received.data(), received.size()), std::ssize(received));
+    } };
+
+    std::vector<struct iovec> iovecs {};
+    for (unsigned long long offset = 0; offset < buffer.size(); offset += 40'000) iovecs.push_back({ buffer.data() + offset, 40'000 });
+    bool is_written {};
+    for (unsigned long long i = 0; i < iovecs.size();) { // a full pipe fails with EAGAIN, the consumed iovecs pick up where it stopped
+        is_written = ::__writev_fully(pipefds[1], iovecs.data() + i, iovecs.size() - i);
+        if (is_written) break;
+        ASSERT_EQ(errno, EAGAIN);
+        while (i < iovecs.size() && !iovecs[i].iov_len) ++i;
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(is_written);
+    ::close(pipefds[1]);
+    reader.join();
+    ::close(pipefds[0]);
+    EXPECT_TRUE(std::equal(buffer.cbegin(), buffer.cend(), received.cbegin()));
+}
+
+#if FILEIO_HAS_URING
+TEST(fileio, uring) {
+    ::uring_t ring {};
+    if (!::uring_init(&ring, 4)) GTEST_SKIP() << "io_uring is unavailable";
+
+    std::vector<unsigned char> buffer(200'000);
+    std::vector<unsigned char> received(buffer.size());
+    std::mt19937_64            rndengine { std::random_device {}() };
+    unsigned long long         user_data {};
+    int                        result {};
+    std::generate(buffer.begin(), buffer.end(), [&rndengine]() noexcept -> auto { return static_cast<unsigned char>(rndengine()); });
+
+    // two writes of the halves of the buffer in one submission, their completions may come in either order
+    const int fdesc = ::open(R"(./files/temp07.dat)", O_CREAT | O_RDWR | O_TRUNC, S_IRUSR | S_IWUSR);
+    ASSERT_NE(fdesc, -1);
+    EXPECT_TRUE(::uring_queue_rw(&ring, IORING_OP_WRITE, fdesc, buffer.data(), 100'000, 0, 0, 1));
+    EXPECT_TRUE(::uring_queue_rw(&ring, IORING_OP_WRITE, fdesc, buffer.data() + 100'000, 100'000, 100'000, 0, 2));
+    unsigned long long seen {};
+    for (unsigned i = 0; i < 2; ++i) {
+        ASSERT_TRUE(::uring_wait(&ring, &user_data, &result));
+        EXPECT_EQ(result, 100'000);
+        seen |= user_data;
+    }
+    EXPECT_EQ(seen, 3LLU);
+    EXPECT_FALSE(::uring_wait(&ring, &user_data, &result)); // nothing left in flight
+
+    // a fixed read into a registered buffer
+    const struct iovec iovec { received.data(), received.size() };
+    if (::uring_register_buffers(&ring, &iovec, 1)) {
+        EXPECT_TRUE(::uring_queue_rw(&ring, IORING_OP_READ_FIXED, fdesc, received.data(), received.size(), 0, 0, 3));
+        ASSERT_TRUE(::uring_wait(&ring, &user_data, &result));
+        EXPECT_EQ(user_data, 3LLU);
+        EXPECT_EQ(result, static_cast<int>(received.size()));
+        EXPECT_TRUE(std::equal(buffer.cbegin(), buffer.cend(), received.cbegin()));
+    }
+
+    // the submission queue holds as many requests as the ring was set up for
+    for (unsigned i = 0; i < ring.nentries; ++i) EXPECT_TRUE(::uring_queue_rw(&ring, IORING_OP_READ, fdesc, received.data(), 16, 0, 0, i));
+    EXPECT_FALSE(::uring_queue_rw(&ring, IORING_OP_READ, fdesc, received.data(), 16, 0, 0, 0));
+    for (unsigned i = 0; i < ring.nentries; ++i) EXPECT_TRUE(::uring_wait(&ring, &user_data, &result));
+
+    // errors come back as -errno in the completion
+    EXPECT_TRUE(::uring_queue_rw(&ring, IORING_OP_READ, -1, received.data(), 16, 0, 0, 4));
+    ASSERT_TRUE(::uring_wait(&ring, &user_data, &result));
+    EXPECT_EQ(result, -EBADF);
+
+    ::uring_close(&ring);
+    ::close(fdesc);
+    EXPECT_FALSE(::remove(R"(./files/temp07.dat)"));
+}
+#endif
+
+TEST(fileio, filebatch) {
+    // the same file more than once, an empty file and a file that does not exist in the middle of the list
+    EXPECT_TRUE(::__write(R"(./files/temp08.dat)", reinterpret_cast<const unsigned char*>(""), 0));
+    const char* const paths[] = { R"(./files/bronze.jpg)",   R"(./files/mobydick.txt)", R"(./files/temp08.dat)",
+                                  R"(./files/synth.bin)",    R"(./files/nonexistent.dat)", R"(./files/table.csv)",
+                                  R"(./files/mobydick.txt)", R"(./files/bronze.jpg)" };
+    const unsigned long long npaths = sizeof(paths) / sizeof(*paths);
+
+    std::vector<std::vector<unsigned char>> expected(npaths);
+    for (unsigned long long i = 0; i < npaths; ++i) {
+        long           size {};
+        unsigned char* buffer = ::__read(paths[i], &size);
+        if (buffer) expected[i].assign(buffer, buffer + size);
+        ::free(buffer);
+    }
+
+    // the io_uring path with the default and a shallow depth, and the pread() path, with chunk sizes that leave short last chunks
+    // and one that divides synth.bin's 2'560'000 bytes
+    for (const unsigned depth : { 0U, 3U, 1U }) {
+        for (const unsigned long long chunk_size : { 4'093LLU, 1'024LLU, 1LLU << 20 }) {
+            ::filebatch_t                           batch {};
+            ::filechunk_t                           chunk {};
+            std::vector<std::vector<unsigned char>> contents(npaths);
+            std::vector<unsigned>                   nlast(npaths);
+
+            ASSERT_TRUE(::filebatch_open(&batch, paths, npaths, chunk_size, depth));
+            while (::filebatch_next(&batch, &chunk)) {
+                ASSERT_LT(chunk.file, npaths);
+                EXPECT_EQ(nlast[chunk.file], 0U); // nothing comes after the last chunk
+                EXPECT_EQ(chunk.offset, contents[chunk.file].size());
+                EXPECT_LE(chunk.nbytes, chunk_size);
+                contents[chunk.file].insert(contents[chunk.file].end(), chunk.buffer, chunk.buffer + chunk.nbytes);
+                nlast[chunk.file] += chunk.is_last;
+            }
+            EXPECT_FALSE(::filebatch_close(&batch)); // the nonexistent file
+
+            for (unsigned long long i = 0; i < npaths; ++i) {
+                EXPECT_EQ(nlast[i], i == 4 ? 0U : 1U) << paths[i];
+                EXPECT_EQ(contents[i], expected[i]) << paths[i] << " depth " << depth << " chunk size " << chunk_size;
+            }
+        }
+    }
+
+    // an empty batch, and closing with reads still in flight
+    ::filebatch_t batch {};
+    ::filechunk_t chunk {};
+    ASSERT_TRUE(::filebatch_open(&batch, paths, 0, 0, 0));
+    EXPECT_FALSE(::filebatch_next(&batch, &chunk));
+    EXPECT_TRUE(::filebatch_close(&batch));
+    ASSERT_TRUE(::filebatch_open(&batch, paths, 2, 4'096, 0));
+    EXPECT_TRUE(::filebatch_next(&batch, &chunk));
+    EXPECT_TRUE(::filebatch_close(&batch));
+
+    EXPECT_FALSE(::remove(R"(./files/temp08.dat)"));
+}
+
+TEST(fileio, __write_batch) {
+    static constexpr unsigned long long nfiles { 40 };
+    std::mt19937_64                     rndengine { std::random_device {}() };
+    std::vector<std::vector<unsigned char>> buffers(nfiles);
+    std::vector<std::string>                names(nfiles);
+    std::vector<const char*>                paths(nfiles);
+    std::vector<const unsigned char*>       pointers(nfiles);
+    std::vector<unsigned long long>         sizes(nfiles);
+    long                                    fsize {};
+
+    for (unsigned long long i = 0; i < nfiles; ++i) {
+        buffers[i].resize(i % 10 ? rndengine() % 300'000 : 0); // every tenth file is empty
+        for (auto& byte : buffers[i]) byte = static_cast<unsigned char>(rndengine());
+        names[i]    = "./files/temp09_" + std::to_string(i) + ".dat";
+        paths[i]    = names[i].c_str();
+        pointers[i] = buffers[i].data();
+        sizes[i]    = buffers[i].size();
+    }
+
+    // the second round writes half as many bytes into every file, which must be truncated
+    for (const bool is_shrinking : { false, true }) {
+        if (is_shrinking)
+            for (unsigned long long i = 0; i < nfiles; ++i) buffers[i].resize(sizes[i] /= 2);
+        EXPECT_TRUE(::__write_batch(paths.data(), pointers.data(), sizes.data(), nfiles));
+
+        for (unsigned long long i = 0; i < nfiles; ++i) {
+            unsigned char* const fbuffer = ::__read(paths[i], &fsize);
+            ASSERT_TRUE(fbuffer) << paths[i];
+            EXPECT_EQ(static_cast<unsigned long long>(fsize), sizes[i]);
+            EXPECT_TRUE(std::equal(buffers[i].cbegin(), buffers[i].cend(), fbuffer));
+            ::free(fbuffer);
+        }
+    }
+    for (const auto* const path : paths) EXPECT_FALSE(::remove(path));
+
+    const char* const          unwritable[] = { R"(./nonexistent/temp09.dat)", R"(./files/temp10.dat)" };
+    const unsigned char* const contents[]   = { pointers[1], pointers[2] };
+    EXPECT_FALSE(::__write_batch(unwritable, contents, sizes.data() + 1, 2));
+    EXPECT_FALSE(::remove(R"(./files/temp10.dat)")); // the other file still gets written
+}
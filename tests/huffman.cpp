@@ -1,12 +1,17 @@
 #include <algorithm>
 #include <ctime>
+#include <map>
+#include <numeric>
 #include <random>
+#include <set>
+#include <utility>
 #include <vector>
 
 #include <test.hpp>
 
 extern "C" {
 #define restrict
+#include <bitops.h>
 #include <huffman.h>
 #undef restrict
 }
@@ -43,3 +48,535 @@ TEST_F(CustomPQueueFixture, PUSH) {
 TEST_F(CustomPQueueFixture, POP) { }
 
 TEST_F(CustomPQueueFixture, PEEK) { }
+
+TEST(huffman, dpqueue) {
+    std::mt19937_64        rndengine { std::random_device {}() };
+    alignas(64) ::btnode_t buffer[GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY] {};
+    std::vector<unsigned>  frequencies(GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY - HUFFMAN_PQUEUE_ARITY + 1);
+    ::btnode_t             node {};
+
+    auto prqueue = ::dpqueue_init(buffer, GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+    EXPECT_EQ(prqueue.capacity, frequencies.size());
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(prqueue.tree + 1) % (HUFFMAN_PQUEUE_ARITY * sizeof(::btnode_t)), 0U); // the root's children
+    EXPECT_FALSE(::dpqueue_pop(&prqueue, &node));
+
+    // duplicates are welcome, every partially filled group of siblings gets visited on the way down
+    std::generate(frequencies.begin(), frequencies.end(), [&]() noexcept -> auto { return static_cast<unsigned>(rndengine() % 500); });
+    for (unsigned i = 0; i < frequencies.size(); ++i) {
+        node.frequency = frequencies[i];
+        node.symbol    = static_cast<unsigned short>(i);
+        ASSERT_TRUE(::dpqueue_push(&prqueue, node));
+        EXPECT_EQ(::dpqueue_peek(&prqueue).frequency, *std::min_element(frequencies.cbegin(), frequencies.cbegin() + i + 1));
+    }
+    EXPECT_FALSE(::dpqueue_push(&prqueue, node)); // full
+
+    std::sort(frequencies.begin(), frequencies.end());
+    for (const auto& frequency : frequencies) {
+        ASSERT_TRUE(::dpqueue_pop(&prqueue, &node));
+        EXPECT_EQ(node.frequency, frequency);
+    }
+    EXPECT_FALSE(prqueue.count);
+    ::dpqueue_clean(&prqueue);
+    EXPECT_FALSE(prqueue.tree);
+}
+
+#if HUFFMAN_PQUEUE_LAZY
+TEST(huffman, pqueue_lazy) {
+    ::btnode_t buffer[GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY] {}, node {}; // NOLINT(readability-isolate-declaration)
+    ::memset(buffer, 0xAB, sizeof(buffer));                              // poison, none of it should be touched past what gets pushed
+
+    auto prqueue = ::pqueue_init(buffer, GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+    EXPECT_EQ(::pqueue_peek(&prqueue).frequency, 0U); // an empty queue does not read its stale slots
+    for (unsigned i = 0; i < BYTECOUNT; ++i) {
+        node.frequency = BYTECOUNT - i;
+        ASSERT_TRUE(::pqueue_push(&prqueue, node));
+    }
+    for (unsigned i = 0; i < BYTECOUNT; ++i) {
+        ASSERT_TRUE(::pqueue_pop(&prqueue, &node));
+        EXPECT_EQ(node.frequency, i + 1);
+    }
+    EXPECT_FALSE(prqueue.tree); // the last pop cleaned the queue, but only the struct
+
+    EXPECT_TRUE(std::all_of(
+        reinterpret_cast<const unsigned char*>(buffer + BYTECOUNT),
+        reinterpret_cast<const unsigned char*>(std::end(buffer)),
+        [](const unsigned char byte) noexcept -> bool { return byte == 0xAB; }
+    ));
+}
+#endif
+
+TEST(huffman, pqueue_from_array) {
+    std::mt19937_64       rndengine { std::random_device {}() };
+    ::btnode_t            buffer[GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY] {};
+    std::vector<unsigned> frequencies(BYTECOUNT);
+    ::btnode_t            node {}, batch[BYTECOUNT] {}; // NOLINT(readability-isolate-declaration)
+
+    std::generate(frequencies.begin(), frequencies.end(), [&]() noexcept -> auto { return static_cast<unsigned>(rndengine() % 500); });
+    for (unsigned i = 0; i < BYTECOUNT; ++i) {
+        buffer[i].frequency = batch[i].frequency = frequencies[i];
+        buffer[i].symbol = batch[i].symbol = static_cast<unsigned short>(i);
+    }
+
+    // heapified in place, then a batch as large as the queue (heapified again) and a small one (pushed node by node)
+    auto prqueue = ::pqueue_from_array(buffer, GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY, BYTECOUNT);
+    EXPECT_EQ(prqueue.count, BYTECOUNT);
+    EXPECT_EQ(::pqueue_peek(&prqueue).frequency, *std::min_element(frequencies.cbegin(), frequencies.cend()));
+    ASSERT_TRUE(::pqueue_push_bulk(&prqueue, batch, BYTECOUNT));
+    ASSERT_TRUE(::pqueue_push_bulk(&prqueue, batch, 100));
+    EXPECT_FALSE(::pqueue_push_bulk(&prqueue, buffer, GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY)); // turned down before the batch is read
+    EXPECT_TRUE(::pqueue_push_bulk(&prqueue, nullptr, 0));
+    EXPECT_EQ(prqueue.count, 2 * BYTECOUNT + 100);
+    frequencies.insert(frequencies.end(), frequencies.cbegin(), frequencies.cend());
+    frequencies.insert(frequencies.end(), frequencies.cbegin(), frequencies.cbegin() + 100);
+
+    std::sort(frequencies.begin(), frequencies.end());
+    for (const auto& frequency : frequencies) {
+        ASSERT_TRUE(::pqueue_pop(&prqueue, &node));
+        EXPECT_EQ(node.frequency, frequency);
+    }
+    EXPECT_FALSE(prqueue.count);
+}
+
+TEST(huffman, pqueue_replace_top) {
+    std::mt19937_64         rndengine { std::random_device {}() };
+    alignas(64) ::btnode_t  buffer[GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY] {}, dbuffer[GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY] {};
+    std::multiset<unsigned> expected {};
+    ::btnode_t              node {}, popped {}, dpopped {}; // NOLINT(readability-isolate-declaration)
+
+    auto prqueue = ::pqueue_init(buffer, GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+    auto dpqueue = ::dpqueue_init(dbuffer, GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+    EXPECT_FALSE(::pqueue_replace_top(&prqueue, node, &popped));
+    EXPECT_FALSE(::dpqueue_replace_top(&dpqueue, node, &dpopped));
+    node.frequency = 7;
+    ::pqueue_pushpop(&prqueue, node, &popped); // an empty queue hands the node straight back
+    EXPECT_EQ(popped.frequency, 7U);
+    EXPECT_FALSE(prqueue.count);
+
+    for (unsigned i = 0; i < BYTECOUNT; ++i) {
+        node.frequency = static_cast<unsigned>(rndengine() % 1000);
+        ASSERT_TRUE(::pqueue_push(&prqueue, node));
+        ASSERT_TRUE(::dpqueue_push(&dpqueue, node));
+        expected.insert(node.frequency);
+    }
+
+    // both queues mirror a multiset through a mix of replacements and pushpops
+    for (unsigned i = 0; i < 4 * BYTECOUNT; ++i) {
+        node.frequency = static_cast<unsigned>(rndengine() % 1000);
+        if (i % 2) {
+            ASSERT_TRUE(::pqueue_replace_top(&prqueue, node, &popped));
+            ASSERT_TRUE(::dpqueue_replace_top(&dpqueue, node, &dpopped));
+            EXPECT_EQ(popped.frequency, *expected.cbegin());
+            expected.erase(expected.cbegin());
+            expected.insert(node.frequency);
+        } else {
+            ::pqueue_pushpop(&prqueue, node, &popped);
+            ::dpqueue_pushpop(&dpqueue, node, &dpopped);
+            expected.insert(node.frequency);
+            EXPECT_EQ(popped.frequency, *expected.cbegin());
+            expected.erase(expected.cbegin());
+        }
+        EXPECT_EQ(popped.frequency, dpopped.frequency);
+        EXPECT_EQ(prqueue.count, BYTECOUNT);
+        EXPECT_EQ(dpqueue.count, BYTECOUNT);
+    }
+
+    for (const auto& frequency : expected) {
+        ASSERT_TRUE(::pqueue_pop(&prqueue, &popped));
+        ASSERT_TRUE(::dpqueue_pop(&dpqueue, &dpopped));
+        EXPECT_EQ(popped.frequency, frequency);
+        EXPECT_EQ(dpopped.frequency, frequency);
+    }
+}
+
+static constexpr const char* const test_files[] = { R"(./files/bronze.jpg)", R"(./files/mobydick.txt)", R"(./files/synth.bin)", R"(./files/table.csv)" };
+
+TEST(huffman, scan_frequencies) {
+    long               size {};
+    unsigned long long expected[BYTECOUNT] {}, frequencies[BYTECOUNT] {}; // NOLINT(readability-isolate-declaration)
+
+    for (const auto& path : test_files) {
+        auto* const buffer = ::__read(path, &size);
+        ASSERT_TRUE(buffer);
+
+        // sizes that leave every possible tail after the 16 byte rounds, at offsets that misalign the loads
+        for (const long length : { 1L, 15L, 16L, 17L, 31L, 1000L, size - 3 }) {
+            ::scan_frequencies_single(buffer + 3, length, expected);
+            ::scan_frequencies(buffer + 3, length, frequencies);
+            EXPECT_TRUE(std::equal(std::cbegin(expected), std::cend(expected), std::cbegin(frequencies)));
+        }
+        ::free(buffer);
+    }
+
+    const std::vector<unsigned char> zeroes(100'003); // one long run
+    ::scan_frequencies(zeroes.data(), zeroes.size(), frequencies);
+    EXPECT_EQ(frequencies[0], zeroes.size());
+    EXPECT_EQ(std::count(std::cbegin(frequencies), std::cend(frequencies), 0LLU), static_cast<std::ptrdiff_t>(BYTECOUNT - 1));
+}
+
+TEST(huffman, scan_frequencies_parallel) {
+    std::mt19937_64            rndengine { std::random_device {}() };
+    std::vector<unsigned char> buffer(HUFFMAN_THREAD_MIN_SIZE * 5 + 12'345);
+    unsigned long long         expected[BYTECOUNT] {}, frequencies[BYTECOUNT] {}; // NOLINT(readability-isolate-declaration)
+
+    std::generate(buffer.begin(), buffer.end(), [&]() noexcept -> auto { return static_cast<unsigned char>(rndengine() % 7); });
+    ::scan_frequencies_single(buffer.data(), buffer.size(), expected);
+
+    // no threads means one per processor, more threads than slices get clamped
+    for (const unsigned long long nthreads : { 0LLU, 1LLU, 2LLU, 3LLU, 6LLU, 7LLU, HUFFMAN_MAX_THREADS + 1 }) {
+        ::scan_frequencies_parallel(buffer.data(), buffer.size(), frequencies, nthreads);
+        EXPECT_TRUE(std::equal(std::cbegin(expected), std::cend(expected), std::cbegin(frequencies)));
+
+        ::scan_frequencies_parallel(buffer.data() + 1, 1000, frequencies, nthreads); // too small to be split
+        ::scan_frequencies_single(buffer.data() + 1, 1000, expected);
+        EXPECT_TRUE(std::equal(std::cbegin(expected), std::cend(expected), std::cbegin(frequencies)));
+        ::scan_frequencies_single(buffer.data(), buffer.size(), expected);
+    }
+}
+
+TEST(huffman, build_code_table) {
+    long                    size {};
+    unsigned long long      frequencies[BYTECOUNT] {};
+    ::hcode_t               codes[BYTECOUNT] {};
+    std::vector<::btnode_t> pqueue_buffer(GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY), bntree_buffer(GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+
+    for (const auto& path : test_files) {
+        auto* const buffer = ::__read(path, &size);
+        ASSERT_TRUE(buffer);
+        // whole files can have symbols rare enough to need codes longer than HUFFMAN_MAX_CODE_LENGTH, so stick to a block
+        ::scan_frequencies(buffer, std::min<unsigned long long>(size, HUFFMAN_BLOCK_SIZE), frequencies);
+        ::free(buffer);
+
+        const auto huffman = ::build_huffman_tree(frequencies, pqueue_buffer.data(), bntree_buffer.data());
+        if (!::build_code_table(&huffman, codes)) { // the tree was deeper than HUFFMAN_MAX_CODE_LENGTH, do what compress() does
+            unsigned char lengths[BYTECOUNT] {};
+            ASSERT_TRUE(::build_limited_code_lengths(frequencies, HUFFMAN_MAX_CODE_LENGTH, lengths));
+            ASSERT_TRUE(::build_canonical_codes(lengths, codes));
+        }
+
+        double kraft {};
+        for (unsigned i = 0; i < BYTECOUNT; ++i) {
+            EXPECT_EQ(codes[i].is_used, frequencies[i] != 0);
+            EXPECT_LE(codes[i].length, HUFFMAN_MAX_CODE_LENGTH);
+            if (codes[i].is_used) kraft += 1.0 / static_cast<double>(1LLU << codes[i].length);
+        }
+        EXPECT_DOUBLE_EQ(kraft, 1.0); // Huffman codes are complete
+
+        for (unsigned i = 0; i < BYTECOUNT; ++i) { // and prefix free
+            for (unsigned j = 0; j < BYTECOUNT; ++j) {
+                if (i == j || !codes[i].is_used || !codes[j].is_used || codes[i].length > codes[j].length) continue;
+                EXPECT_NE(codes[i].code, codes[j].code >> (codes[j].length - codes[i].length));
+            }
+        }
+    }
+}
+
+TEST(huffman, build_huffman_tree_linear) {
+    std::mt19937_64         rndengine { std::random_device {}() };
+    unsigned long long      frequencies[BYTECOUNT] {};
+    unsigned char           expected[BYTECOUNT] {}, lengths[BYTECOUNT] {}; // NOLINT(readability-isolate-declaration)
+    std::vector<::btnode_t> pqueue_buffer(GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY), bntree_buffer(GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+
+    // zero, one and two symbols, then histograms of random sparsity with plenty of ties
+    for (unsigned round = 0; round < 512; ++round) {
+        const unsigned nsymbols = round < 3 ? round : static_cast<unsigned>(rndengine() % BYTECOUNT) + 1;
+        std::fill(std::begin(frequencies), std::end(frequencies), 0LLU);
+        for (unsigned i = 0; i < nsymbols; ++i) frequencies[rndengine() % BYTECOUNT] = rndengine() % 64 + 1;
+        const auto nleaves = static_cast<unsigned long long>(std::count_if(std::cbegin(frequencies), std::cend(frequencies), [](auto f) { return f; }));
+
+        const auto linear  = ::build_huffman_tree_linear(frequencies, bntree_buffer.data());
+        EXPECT_EQ(linear.node_count, nleaves ? 2 * nleaves - 1 : 0);
+        if (!nleaves) {
+            EXPECT_FALSE(linear.root);
+            continue;
+        }
+        EXPECT_EQ(linear.root->frequency, std::accumulate(std::cbegin(frequencies), std::cend(frequencies), 0LLU));
+
+        // ties can be broken differently, so the trees may differ in shape (and depth) but never in the cost of the code
+        const auto heap = ::build_huffman_tree(frequencies, pqueue_buffer.data(), bntree_buffer.data() + BYTECOUNT * 2);
+        if (!::build_code_lengths(&linear, lengths) || !::build_code_lengths(&heap, expected)) continue;
+
+        unsigned long long cost {}, expected_cost {};
+        for (unsigned i = 0; i < BYTECOUNT; ++i) {
+            EXPECT_EQ(lengths[i] != 0, frequencies[i] != 0);
+            cost          += frequencies[i] * lengths[i];
+            expected_cost += frequencies[i] * expected[i];
+        }
+        EXPECT_EQ(cost, expected_cost);
+    }
+
+    // btnode_t counts in 32 bits, so trees over more symbols than that are refused
+    std::fill(std::begin(frequencies), std::end(frequencies), 0LLU);
+    frequencies['A'] = frequencies['B'] = 1LLU << 31;
+    EXPECT_FALSE(::build_huffman_tree_linear(frequencies, bntree_buffer.data()).root);
+    EXPECT_FALSE(::build_huffman_tree(frequencies, pqueue_buffer.data(), bntree_buffer.data()).root);
+}
+
+TEST(huffman, build_code_lengths_inplace) {
+    std::mt19937_64         rndengine { std::random_device {}() };
+    unsigned long long      frequencies[BYTECOUNT] {};
+    unsigned char           expected[BYTECOUNT] {}, lengths[BYTECOUNT] {}; // NOLINT(readability-isolate-declaration)
+    std::vector<::btnode_t> bntree_buffer(GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+
+    // worked out by hand, 1 + 1, 1 + 1, 2 + 2, (2) + (2), 4 + (4), (4) + 5, 8 + (8), (9) + 13, (16) + (22)
+    unsigned long long example[] { 1, 1, 1, 1, 2, 2, 4, 5, 8, 13 };
+    ::minimum_redundancy_lengths(example, std::size(example));
+    const unsigned long long example_lengths[] { 5, 5, 5, 5, 4, 4, 3, 3, 2, 2 };
+    EXPECT_TRUE(std::equal(std::cbegin(example), std::cend(example), std::cbegin(example_lengths)));
+
+    for (unsigned round = 0; round < 512; ++round) {
+        const unsigned nsymbols = round < 3 ? round : static_cast<unsigned>(rndengine() % BYTECOUNT) + 1;
+        std::fill(std::begin(frequencies), std::end(frequencies), 0LLU);
+        for (unsigned i = 0; i < nsymbols; ++i) frequencies[rndengine() % BYTECOUNT] = rndengine() % 64 + 1;
+
+        // both take ties in favour of the leaves, so the lengths should match the two queue tree exactly
+        const auto huffman  = ::build_huffman_tree_linear(frequencies, bntree_buffer.data());
+        const bool is_fit   = ::build_code_lengths(&huffman, expected);
+        EXPECT_EQ(::build_code_lengths_inplace(frequencies, lengths), is_fit);
+        if (is_fit) { EXPECT_TRUE(std::equal(std::cbegin(expected), std::cend(expected), std::cbegin(lengths))); }
+    }
+}
+
+TEST(huffman, build_canonical_codes) {
+    unsigned char lengths[BYTECOUNT] {};
+    ::hcode_t     codes[BYTECOUNT] {};
+
+    // the example from RFC 1951, section 3.2.2
+    lengths['A'] = lengths['B'] = lengths['C'] = lengths['D'] = lengths['E'] = 3;
+    lengths['F']                                                             = 2;
+    lengths['G'] = lengths['H']                                              = 4;
+    ASSERT_TRUE(::build_canonical_codes(lengths, codes));
+
+    constexpr std::pair<unsigned char, unsigned short> expected[] = {
+        { 'A',  0b010 },
+        { 'B',  0b011 },
+        { 'C',  0b100 },
+        { 'D',  0b101 },
+        { 'E',  0b110 },
+        { 'F',   0b00 },
+        { 'G', 0b1110 },
+        { 'H', 0b1111 }
+    };
+    for (const auto& [symbol, code] : expected) {
+        EXPECT_TRUE(codes[symbol].is_used);
+        EXPECT_EQ(codes[symbol].length, lengths[symbol]);
+        EXPECT_EQ(codes[symbol].code, code);
+    }
+    for (unsigned i = 0; i < BYTECOUNT; ++i) EXPECT_EQ(codes[i].is_used, lengths[i] != 0);
+
+    lengths['I'] = 2; // three 2 bit codes and five 3 bit codes need more code space than there is
+    EXPECT_FALSE(::build_canonical_codes(lengths, codes));
+
+    lengths['I'] = HUFFMAN_MAX_CODE_LENGTH + 1;
+    EXPECT_FALSE(::build_canonical_codes(lengths, codes));
+}
+
+TEST(huffman, build_limited_code_lengths) {
+    unsigned long long      frequencies[BYTECOUNT] {};
+    unsigned char           lengths[BYTECOUNT] {}, limited[BYTECOUNT] {};
+    ::hcode_t               codes[BYTECOUNT] {};
+    std::vector<::btnode_t> pqueue_buffer(GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY), bntree_buffer(GLOBAL_BTNODE_BUFFER_FIXEDCAPACITY);
+
+    // fibonacci frequencies make the deepest possible Huffman tree, a path with a leaf hanging off every node
+    frequencies[0] = frequencies[1] = 1;
+    for (unsigned i = 2; i < 24; ++i) frequencies[i] = frequencies[i - 1] + frequencies[i - 2];
+
+    const auto huffman = ::build_huffman_tree(frequencies, pqueue_buffer.data(), bntree_buffer.data());
+    EXPECT_FALSE(::build_code_lengths(&huffman, lengths)); // 23 bit codes
+
+    for (unsigned maxlength = 5; maxlength <= HUFFMAN_MAX_CODE_LENGTH; ++maxlength) {
+        ASSERT_TRUE(::build_limited_code_lengths(frequencies, maxlength, limited));
+        ASSERT_TRUE(::build_canonical_codes(limited, codes));
+
+        unsigned long long kraft {}; // in units of 2^-maxlength
+        for (unsigned i = 0; i < BYTECOUNT; ++i) {
+            EXPECT_EQ(limited[i] != 0, frequencies[i] != 0);
+            EXPECT_LE(limited[i], maxlength);
+            if (limited[i]) kraft += 1LLU << (maxlength - limited[i]);
+        }
+        EXPECT_EQ(kraft, 1LLU << maxlength); // package-merge codes are complete too
+    }
+    EXPECT_FALSE(::build_limited_code_lengths(frequencies, 4, limited)); // 24 symbols need at least 5 bits
+
+    // when the limit does not bind, package-merge must be exactly as good as Huffman
+    long size {};
+    for (const auto& path : test_files) {
+        auto* const buffer = ::__read(path, &size);
+        ASSERT_TRUE(buffer);
+        ::scan_frequencies(buffer, std::min<unsigned long long>(size, 1LLU << 10), frequencies);
+        ::free(buffer);
+
+        const auto tree = ::build_huffman_tree(frequencies, pqueue_buffer.data(), bntree_buffer.data());
+        if (!::build_code_lengths(&tree, lengths)) continue; // the limit binds after all
+        ASSERT_TRUE(::build_limited_code_lengths(frequencies, HUFFMAN_MAX_CODE_LENGTH, limited));
+
+        unsigned long long huffman_cost {}, limited_cost {};
+        for (unsigned i = 0; i < BYTECOUNT; ++i) {
+            huffman_cost += frequencies[i] * lengths[i];
+            limited_cost += frequencies[i] * limited[i];
+        }
+        EXPECT_EQ(huffman_cost, limited_cost);
+    }
+}
+
+TEST(huffman, compress) {
+    long size {};
+
+    for (const auto& path : test_files) {
+        auto* const buffer = ::__read(path, &size);
+        ASSERT_TRUE(buffer);
+
+        std::vector<unsigned char> compressed(::compress_bound(size));
+        const auto                 nbytes = ::compress(buffer, compressed.data(), size);
+        EXPECT_LE(nbytes, ::compress_bound(size));
+
+        // walk the stream and decode it bit by bit with a reverse lookup of the code table
+        const unsigned char* caret = compressed.data();
+        unsigned long long   rawsize {};
+        ::memcpy(&rawsize, caret, sizeof(unsigned long long));
+        caret += sizeof(unsigned long long);
+        EXPECT_EQ(rawsize, static_cast<unsigned long long>(size));
+
+        std::vector<unsigned char> decoded {};
+        while (decoded.size() < rawsize) {
+            const unsigned long long blocksize = std::min(rawsize - decoded.size(), HUFFMAN_BLOCK_SIZE);
+
+            if (*caret++ == BLOCK_STORED) {
+                decoded.insert(decoded.end(), caret, caret + blocksize);
+                caret += blocksize;
+                continue;
+            }
+
+            unsigned char lengths[BYTECOUNT] {};
+            ::hcode_t     codes[BYTECOUNT] {};
+            unsigned      bitstreamsize {};
+            ::memcpy(lengths, caret, sizeof(lengths));
+            caret += sizeof(lengths);
+            ASSERT_TRUE(::build_canonical_codes(lengths, codes));
+            ::memcpy(&bitstreamsize, caret, sizeof(unsigned));
+            caret += sizeof(unsigned);
+
+            std::map<std::pair<unsigned, unsigned>, unsigned char> reverse {};
+            for (unsigned i = 0; i < BYTECOUNT; ++i)
+                if (codes[i].is_used) reverse[{ codes[i].length, codes[i].code }] = static_cast<unsigned char>(i);
+
+            unsigned long long offset {};
+            for (unsigned long long i = 0; i < blocksize; ++i) {
+                unsigned code {}, length {};
+                while (!reverse.contains({ length, code })) {
+                    code = (code << 1) | ::getbit(caret, offset++);
+                    ASSERT_LE(++length, HUFFMAN_MAX_CODE_LENGTH);
+                }
+                decoded.push_back(reverse[{ length, code }]);
+            }
+            EXPECT_EQ((offset + 7) / 8, bitstreamsize);
+            caret += bitstreamsize;
+        }
+
+        EXPECT_EQ(static_cast<unsigned long long>(caret - compressed.data()), nbytes);
+        EXPECT_TRUE(std::equal(decoded.cbegin(), decoded.cend(), buffer));
+        ::free(buffer);
+    }
+}
+
+TEST(huffman, build_decode_table) {
+    ::hcode_t   codes[BYTECOUNT] {};
+    ::hdecode_t table[HUFFMAN_DECODE_TABLE_CAPACITY] {};
+
+    // a complete code with lengths 1, 2, ..., HUFFMAN_MAX_CODE_LENGTH, HUFFMAN_MAX_CODE_LENGTH stretches the decode tables as far as they go
+    for (unsigned i = 0; i < HUFFMAN_MAX_CODE_LENGTH; ++i) {
+        codes[i].is_used = true;
+        codes[i].length  = static_cast<unsigned char>(i + 1);
+        codes[i].code    = static_cast<unsigned short>((1U << (i + 1)) - 2); // i ones followed by a zero
+    }
+    codes[HUFFMAN_MAX_CODE_LENGTH] = { true, HUFFMAN_MAX_CODE_LENGTH, (1U << HUFFMAN_MAX_CODE_LENGTH) - 1 }; // all ones
+    ASSERT_TRUE(::build_decode_table(codes, table));
+
+    for (unsigned i = 0; i <= HUFFMAN_MAX_CODE_LENGTH; ++i) {
+        const auto entry = ::decode_symbol(table, static_cast<unsigned long long>(codes[i].code) << (64 - codes[i].length));
+        EXPECT_EQ(entry.value, i);
+        EXPECT_EQ(entry.length, codes[i].length);
+    }
+
+    codes[1].code = 0; // 0 is already taken by the 1 bit code, so this code is no longer prefix free
+    EXPECT_FALSE(::build_decode_table(codes, table));
+}
+
+TEST(huffman, build_multi_table) {
+    ::hcode_t   codes[BYTECOUNT] {};
+    ::hdecode_t table[HUFFMAN_DECODE_TABLE_CAPACITY] {};
+    ::hmulti_t  multi[1LLU << HUFFMAN_DECODE_TABLE_BITS] {};
+
+    // same code as above, so the table has entries with many short codes, entries with few and links to secondary tables
+    for (unsigned i = 0; i < HUFFMAN_MAX_CODE_LENGTH; ++i) {
+        codes[i].is_used = true;
+        codes[i].length  = static_cast<unsigned char>(i + 1);
+        codes[i].code    = static_cast<unsigned short>((1U << (i + 1)) - 2);
+    }
+    codes[HUFFMAN_MAX_CODE_LENGTH] = { true, HUFFMAN_MAX_CODE_LENGTH, (1U << HUFFMAN_MAX_CODE_LENGTH) - 1 };
+    ASSERT_TRUE(::build_decode_table(codes, table));
+    ::build_multi_table(table, multi);
+
+    EXPECT_EQ(multi[0].count, HUFFMAN_MULTI_SYMBOLS); // 0000... is a run of the 1 bit code
+    EXPECT_EQ(multi[0].length, HUFFMAN_MULTI_SYMBOLS);
+    EXPECT_EQ(multi[(1U << HUFFMAN_DECODE_TABLE_BITS) - 1].count, 0); // all ones needs more bits than the table has
+
+    // every entry must agree with decoding its index one symbol at a time
+    for (unsigned i = 0; i < (1U << HUFFMAN_DECODE_TABLE_BITS); ++i) {
+        unsigned long long bits   = static_cast<unsigned long long>(i) << (64 - HUFFMAN_DECODE_TABLE_BITS);
+        unsigned           length = 0;
+        for (unsigned j = 0; j < multi[i].count; ++j) {
+            const auto entry  = ::decode_symbol(table, bits);
+            EXPECT_EQ(multi[i].symbols[j], entry.value);
+            bits   <<= entry.length;
+            length  += entry.length;
+        }
+        EXPECT_EQ(multi[i].length, length);
+        EXPECT_LE(length, HUFFMAN_DECODE_TABLE_BITS);
+    }
+}
+
+TEST(huffman, decompress) {
+    long size {};
+
+    for (const auto& path : test_files) {
+        auto* const buffer = ::__read(path, &size);
+        ASSERT_TRUE(buffer);
+
+        for (const auto& compressor : { ::compress, ::compress_interleaved }) {
+            std::vector<unsigned char> compressed(::compress_bound(size));
+            const auto                 nbytes = compressor(buffer, compressed.data(), size);
+            ASSERT_EQ(::decompressed_size(compressed.data()), static_cast<unsigned long long>(size));
+
+            std::vector<unsigned char> decompressed(size);
+            EXPECT_EQ(::decompress(compressed.data(), decompressed.data(), nbytes), static_cast<unsigned long long>(size));
+            EXPECT_TRUE(std::equal(decompressed.cbegin(), decompressed.cend(), buffer));
+
+            EXPECT_FALSE(::decompress(compressed.data(), decompressed.data(), nbytes / 2)); // a truncated stream
+        }
+        ::free(buffer);
+    }
+}
+
+TEST(huffman, roundtrip) {
+    std::mt19937_64                       rndengine { std::random_device {}() };
+    std::geometric_distribution<unsigned> skewed { 0.4 }; // rare symbols would get codes longer than HUFFMAN_MAX_CODE_LENGTH
+    std::vector<unsigned char>            buffer {}, compressed {}, decompressed {};
+
+    // tiny, one symbol, skewed and block boundary straddling buffers
+    for (const unsigned long long size : { 0LLU, 1LLU, 2LLU, 7LLU, 100LLU, 1000LLU, 4099LLU, HUFFMAN_BLOCK_SIZE, HUFFMAN_BLOCK_SIZE * 3 + 17 }) {
+        for (const bool is_uniform : { true, false }) {
+            for (const auto& compressor : { ::compress, ::compress_interleaved }) {
+                buffer.resize(size);
+                std::generate(buffer.begin(), buffer.end(), [&]() noexcept -> auto {
+                    return static_cast<unsigned char>(is_uniform ? 'A' : std::min(skewed(rndengine), 255U));
+                });
+
+                compressed.resize(::compress_bound(size));
+                decompressed.resize(size);
+                const auto nbytes = compressor(buffer.data(), compressed.data(), size);
+                EXPECT_EQ(::decompress(compressed.data(), decompressed.data(), nbytes), size);
+                EXPECT_EQ(buffer, decompressed);
+            }
+        }
+    }
+}
@@ -1,16 +1,13 @@
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <memory>
+#include <set>
 #include <vector>
 
+#include <pqueue.hpp>
 #include <test.hpp>
 
-extern "C" {
-#define restrict
-#include <pqueue.h>
-#undef restrict
-}
-
 extern "C" {
     // return true when a swap is needed, i.e when the child is heavier than the parent
     [[nodiscard]] static bool comp(const void* const child, const void* const parent) noexcept {
@@ -151,11 +148,11 @@ TEST(pqueue, stress_test) {
         nodeptr = reinterpret_cast<pqueue_stress_test::node_pointer>(::malloc(sizeof(pqueue_stress_test::node_type)));
         ASSERT_TRUE(nodeptr);
         *nodeptr = stress_test_randoms[i];
-        EXPECT_TRUE(::pqueue_push(&prqueue, nodeptr)); // expect about 5 reallocations
+        EXPECT_TRUE(::pqueue_push(&prqueue, nodeptr)); // expect 3 reallocations, 1024 -> 2048 -> 4096 -> 8192
     }
 
     EXPECT_EQ(prqueue.count, ELEMENT_COUNT_WITH_REALLOCATION);
-    EXPECT_EQ(prqueue.capacity, ELEMENT_COUNT_WITH_REALLOCATION); // take into account the 5 extra allocations
+    EXPECT_EQ(prqueue.capacity, std::bit_ceil(ELEMENT_COUNT_WITH_REALLOCATION)); // capacities grow geometrically
     EXPECT_EQ(prqueue.predptr, std::addressof(::nodecomp<pqueue_stress_test::node_type>));
     EXPECT_TRUE(prqueue.tree);
 
@@ -169,3 +166,226 @@ TEST(pqueue, stress_test) {
     EXPECT_FALSE(prqueue.predptr);
     EXPECT_FALSE(prqueue.tree);
 }
+
+TEST(pqueue, reserve_and_shrink) {
+    ::pqueue prqueue {};
+    ASSERT_TRUE(::pqueue_init(&prqueue, ::nodecomp<pqueue_stress_test::node_type>));
+
+    // reserving less than what is there is a no-op
+    EXPECT_TRUE(::pqueue_reserve(&prqueue, DEFAULT_PQUEUE_CAPACITY / 2));
+    EXPECT_EQ(prqueue.capacity, DEFAULT_PQUEUE_CAPACITY);
+
+    // a reserved queue takes all its nodes without growing
+    ASSERT_TRUE(::pqueue_reserve(&prqueue, ELEMENT_COUNT_WITH_REALLOCATION));
+    EXPECT_EQ(prqueue.capacity, ELEMENT_COUNT_WITH_REALLOCATION);
+    EXPECT_FALSE(::pqueue_reserve(&prqueue, UINT32_MAX + 1LLU)); // more than the 32 bit counts can hold
+    EXPECT_EQ(prqueue.capacity, ELEMENT_COUNT_WITH_REALLOCATION);
+
+    for (const auto& record : stress_test_randoms)
+        EXPECT_TRUE(::pqueue_push(&prqueue, const_cast<pqueue_stress_test::node_pointer>(&record))); // the queue only borrows the nodes
+    EXPECT_EQ(prqueue.capacity, ELEMENT_COUNT_WITH_REALLOCATION);
+
+    // one more push doubles the capacity
+    EXPECT_TRUE(::pqueue_push(&prqueue, const_cast<pqueue_stress_test::node_pointer>(&stress_test_randoms[0])));
+    EXPECT_EQ(prqueue.capacity, ELEMENT_COUNT_WITH_REALLOCATION * PQUEUE_GROWTH_FACTOR);
+    EXPECT_TRUE(::pqueue_shrink_to_fit(&prqueue));
+    EXPECT_EQ(prqueue.capacity, ELEMENT_COUNT_WITH_REALLOCATION + 1);
+
+    void* popped {};
+    for (size_t i = 0; i < ELEMENT_COUNT_WITH_REALLOCATION - 10; ++i) EXPECT_TRUE(::pqueue_pop(&prqueue, &popped));
+    EXPECT_TRUE(::pqueue_shrink_to_fit(&prqueue)); // but not below the initial capacity
+    EXPECT_EQ(prqueue.capacity, DEFAULT_PQUEUE_CAPACITY);
+    EXPECT_EQ(prqueue.count, 11U);
+
+    while (::pqueue_pop(&prqueue, &popped)) continue; // pqueue_clean() would free() the nodes, which the queue only borrowed
+    EXPECT_FALSE(prqueue.tree);
+}
+
+TEST(pqueue, from_array) {
+    std::vector<pqueue_stress_test::node_pointer> nodes {};
+    for (auto& record : stress_test_randoms) nodes.push_back(std::addressof(record));
+
+    ::pqueue prqueue {};
+    ASSERT_TRUE(
+        ::pqueue_from_array(&prqueue, reinterpret_cast<void* const*>(nodes.data()), 100, ::nodecomp<pqueue_stress_test::node_type>)
+    );
+    EXPECT_EQ(prqueue.count, 100U);
+    EXPECT_EQ(prqueue.capacity, DEFAULT_PQUEUE_CAPACITY);
+
+    // a batch larger than the queue gets heapified along with it, a smaller one is pushed node by node
+    ASSERT_TRUE(::pqueue_push_bulk(&prqueue, reinterpret_cast<void* const*>(nodes.data() + 100), ELEMENT_COUNT_WITH_REALLOCATION - 150));
+    ASSERT_TRUE(::pqueue_push_bulk(&prqueue, reinterpret_cast<void* const*>(nodes.data() + ELEMENT_COUNT_WITH_REALLOCATION - 50), 50));
+    EXPECT_EQ(prqueue.count, ELEMENT_COUNT_WITH_REALLOCATION);
+
+    void* popped {};
+    for (size_t i = 0; i < ELEMENT_COUNT_WITH_REALLOCATION; ++i) {
+        EXPECT_TRUE(::pqueue_pop(&prqueue, &popped));
+        EXPECT_EQ(reinterpret_cast<pqueue_stress_test::node_pointer>(popped)->unit_price, stress_test_randoms_sorted[i].unit_price);
+    }
+    EXPECT_FALSE(prqueue.tree); // the last pop cleaned the queue
+}
+
+TEST(pqueue, replace_top_pushpop) {
+    ::pqueue                             prqueue {};
+    void*                                popped {};
+    std::multiset<float, std::greater<>> expected {}; // the unit prices in the queue, heaviest first
+    ASSERT_TRUE(::pqueue_init(&prqueue, ::nodecomp<pqueue_stress_test::node_type>));
+
+    auto* const first = const_cast<pqueue_stress_test::node_pointer>(&stress_test_randoms[0]);
+    EXPECT_FALSE(::pqueue_replace_top(&prqueue, first, &popped));
+    ::pqueue_pushpop(&prqueue, first, &popped); // an empty queue hands the node straight back
+    EXPECT_EQ(popped, first);
+
+    for (size_t i = 0; i < ELEMENT_COUNT_WITHOUT_REALLOCATION; ++i) {
+        EXPECT_TRUE(::pqueue_push(&prqueue, const_cast<pqueue_stress_test::node_pointer>(&stress_test_randoms[i])));
+        expected.insert(stress_test_randoms[i].unit_price);
+    }
+
+    // the queue mirrors the multiset through a mix of replacements and pushpops
+    for (size_t i = ELEMENT_COUNT_WITHOUT_REALLOCATION; i < ELEMENT_COUNT_WITH_REALLOCATION; ++i) {
+        auto* const node = const_cast<pqueue_stress_test::node_pointer>(&stress_test_randoms[i]);
+        if (i % 2) {
+            EXPECT_TRUE(::pqueue_replace_top(&prqueue, node, &popped));
+            EXPECT_EQ(reinterpret_cast<pqueue_stress_test::node_pointer>(popped)->unit_price, *expected.cbegin());
+            expected.erase(expected.cbegin());
+            expected.insert(node->unit_price);
+        } else {
+            ::pqueue_pushpop(&prqueue, node, &popped);
+            expected.insert(node->unit_price);
+            EXPECT_EQ(reinterpret_cast<pqueue_stress_test::node_pointer>(popped)->unit_price, *expected.cbegin());
+            expected.erase(expected.cbegin());
+        }
+    }
+    EXPECT_EQ(prqueue.count, ELEMENT_COUNT_WITHOUT_REALLOCATION);
+
+    for (const auto& unit_price : expected) {
+        EXPECT_TRUE(::pqueue_pop(&prqueue, &popped));
+        EXPECT_EQ(reinterpret_cast<pqueue_stress_test::node_pointer>(popped)->unit_price, unit_price);
+    }
+    EXPECT_FALSE(prqueue.tree); // the last pop cleaned the queue
+}
+
+// THE VALUE STORING VARIANT
+
+TEST(vpqueue, push_pop_peek) {
+    ::vpqueue              prqueue {};
+    pqueue_test::node_type popped {};
+    ASSERT_TRUE(::vpqueue_init(&prqueue, sizeof(pqueue_test::node_type), ::comp));
+    EXPECT_EQ(prqueue.capacity, DEFAULT_PQUEUE_CAPACITY);
+    EXPECT_EQ(prqueue.size, sizeof(pqueue_test::node_type));
+    EXPECT_FALSE(::vpqueue_peek(&prqueue));
+    EXPECT_FALSE(::vpqueue_pop(&prqueue, &popped));
+
+    for (const auto& random : randoms) EXPECT_TRUE(::vpqueue_push(&prqueue, &random)); // the queue keeps copies, no mallocs needed
+    EXPECT_EQ(prqueue.count, ELEMENT_COUNT_WITHOUT_REALLOCATION);
+
+    for (size_t i = 0; i < ELEMENT_COUNT_WITHOUT_REALLOCATION; ++i) {
+        EXPECT_EQ(*reinterpret_cast<pqueue_test::constant_node_pointer>(::vpqueue_peek(&prqueue)), randoms_sorted[i]);
+        EXPECT_TRUE(::vpqueue_pop(&prqueue, &popped));
+        EXPECT_EQ(popped, randoms_sorted[i]);
+    }
+
+    // running dry leaves the queue usable
+    EXPECT_FALSE(prqueue.count);
+    EXPECT_TRUE(prqueue.tree);
+    EXPECT_TRUE(::vpqueue_push(&prqueue, &randoms[0]));
+    EXPECT_TRUE(::vpqueue_pop(&prqueue, &popped));
+    EXPECT_EQ(popped, randoms[0]);
+
+    ::vpqueue_clean(&prqueue);
+    EXPECT_FALSE(prqueue.tree);
+}
+
+TEST(vpqueue, stress_test) {
+    value_pqueue<pqueue_stress_test::node_type> prqueue {};
+    pqueue_stress_test::node_type               popped {};
+    ASSERT_TRUE(prqueue.is_valid());
+
+    for (const auto& record : stress_test_randoms) EXPECT_TRUE(prqueue.push(record));
+    EXPECT_EQ(prqueue.size(), ELEMENT_COUNT_WITH_REALLOCATION);
+    EXPECT_GE(prqueue.base().capacity, ELEMENT_COUNT_WITH_REALLOCATION);
+
+    for (size_t i = 0; i < ELEMENT_COUNT_WITH_REALLOCATION; ++i) {
+        EXPECT_EQ(prqueue.peek()->unit_price, stress_test_randoms_sorted[i].unit_price);
+        EXPECT_TRUE(prqueue.pop(popped));
+        EXPECT_EQ(popped.unit_price, stress_test_randoms_sorted[i].unit_price);
+    }
+    EXPECT_FALSE(prqueue.pop(popped));
+#ifndef PQUEUE_SHRINK_ON_POP
+    EXPECT_EQ(prqueue.base().capacity, std::bit_ceil(ELEMENT_COUNT_WITH_REALLOCATION)); // draining the queue keeps its buffer
+#else
+    EXPECT_EQ(prqueue.base().capacity, DEFAULT_PQUEUE_CAPACITY); // draining the queue gave the memory back
+#endif
+    EXPECT_TRUE(prqueue.shrink_to_fit());
+    EXPECT_EQ(prqueue.base().capacity, DEFAULT_PQUEUE_CAPACITY);
+}
+
+TEST(vpqueue, reserve) {
+    ::vpqueue prqueue {};
+    ASSERT_TRUE(::vpqueue_init(&prqueue, sizeof(pqueue_stress_test::node_type), ::nodecomp<pqueue_stress_test::node_type>));
+    ASSERT_TRUE(::vpqueue_reserve(&prqueue, ELEMENT_COUNT_WITH_REALLOCATION));
+    EXPECT_EQ(prqueue.capacity, ELEMENT_COUNT_WITH_REALLOCATION);
+
+    for (const auto& record : stress_test_randoms) EXPECT_TRUE(::vpqueue_push(&prqueue, &record));
+    EXPECT_EQ(prqueue.capacity, ELEMENT_COUNT_WITH_REALLOCATION);
+    EXPECT_TRUE(::vpqueue_push(&prqueue, &stress_test_randoms[0]));
+    EXPECT_EQ(prqueue.capacity, ELEMENT_COUNT_WITH_REALLOCATION * PQUEUE_GROWTH_FACTOR);
+
+    pqueue_stress_test::node_type popped {};
+    EXPECT_TRUE(::vpqueue_pop(&prqueue, &popped));
+    EXPECT_EQ(popped.unit_price, stress_test_randoms_sorted[0].unit_price);
+
+    ::vpqueue_clean(&prqueue);
+}
+
+TEST(vpqueue, from_array) {
+    ::vpqueue                     prqueue {};
+    pqueue_stress_test::node_type popped {};
+    const auto* const             records = stress_test_randoms.data();
+
+    ASSERT_TRUE(
+        ::vpqueue_from_array(&prqueue, records, 100, sizeof(pqueue_stress_test::node_type), ::nodecomp<pqueue_stress_test::node_type>)
+    );
+    EXPECT_EQ(prqueue.count, 100U);
+    ASSERT_TRUE(::vpqueue_push_bulk(&prqueue, records + 100, ELEMENT_COUNT_WITH_REALLOCATION - 150));
+    ASSERT_TRUE(::vpqueue_push_bulk(&prqueue, records + ELEMENT_COUNT_WITH_REALLOCATION - 50, 50));
+    EXPECT_EQ(prqueue.count, ELEMENT_COUNT_WITH_REALLOCATION);
+
+    for (size_t i = 0; i < ELEMENT_COUNT_WITH_REALLOCATION; ++i) {
+        EXPECT_TRUE(::vpqueue_pop(&prqueue, &popped));
+        EXPECT_EQ(popped.unit_price, stress_test_randoms_sorted[i].unit_price);
+    }
+    ::vpqueue_clean(&prqueue);
+}
+
+TEST(vpqueue, replace_top_pushpop) {
+    value_pqueue<pqueue_stress_test::node_type> prqueue {};
+    pqueue_stress_test::node_type               popped {};
+    std::multiset<float, std::greater<>>        expected {};
+
+    EXPECT_FALSE(prqueue.replace_top(stress_test_randoms[0], popped));
+    for (size_t i = 0; i < ELEMENT_COUNT_WITHOUT_REALLOCATION; ++i) {
+        EXPECT_TRUE(prqueue.push(stress_test_randoms[i]));
+        expected.insert(stress_test_randoms[i].unit_price);
+    }
+
+    for (size_t i = ELEMENT_COUNT_WITHOUT_REALLOCATION; i < ELEMENT_COUNT_WITH_REALLOCATION; ++i) {
+        if (i % 2) {
+            EXPECT_TRUE(prqueue.replace_top(stress_test_randoms[i], popped));
+            EXPECT_EQ(popped.unit_price, *expected.cbegin());
+            expected.erase(expected.cbegin());
+            expected.insert(stress_test_randoms[i].unit_price);
+        } else {
+            prqueue.pushpop(stress_test_randoms[i], popped);
+            expected.insert(stress_test_randoms[i].unit_price);
+            EXPECT_EQ(popped.unit_price, *expected.cbegin());
+            expected.erase(expected.cbegin());
+        }
+    }
+    EXPECT_EQ(prqueue.size(), ELEMENT_COUNT_WITHOUT_REALLOCATION);
+
+    for (const auto& unit_price : expected) {
+        EXPECT_TRUE(prqueue.pop(popped));
+        EXPECT_EQ(popped.unit_price, unit_price);
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <functional>
+#include <type_traits>
+
+extern "C" {
+#define restrict
+#include <pqueue.h>
+#undef restrict
+}
+
+// a typed front end for vpqueue, the element size and the predicate are compile time constants at every call into
+// vpqueue_push_with() and vpqueue_pop_with(), which lets the compiler inline the comparator and the memcpy()s
+// _TyCompare must return true when the child belongs above the parent, std::greater<> makes a max heap like ::comp does
+template<typename _TyValue, typename _TyCompare = std::greater<_TyValue>> class value_pqueue final {
+        static_assert(std::is_trivially_copyable_v<_TyValue>); // the elements get moved around with memcpy()
+
+        ::vpqueue prqueue {};
+
+        [[nodiscard]] static bool predicate(const void* const child, const void* const parent) noexcept {
+            return _TyCompare {}(*reinterpret_cast<const _TyValue*>(child), *reinterpret_cast<const _TyValue*>(parent));
+        }
+
+    public:
+        value_pqueue() noexcept { ::vpqueue_init(&prqueue, sizeof(_TyValue), predicate); }
+
+        value_pqueue(const value_pqueue&)            = delete;
+        value_pqueue& operator=(const value_pqueue&) = delete;
+
+        ~value_pqueue() noexcept { ::vpqueue_clean(&prqueue); }
+
+        [[nodiscard]] bool is_valid() const noexcept { return prqueue.tree; }
+
+        [[nodiscard]] unsigned size() const noexcept { return prqueue.count; }
+
+        [[nodiscard]] const ::vpqueue& base() const noexcept { return prqueue; }
+
+        bool reserve(const unsigned long long capacity) noexcept { return ::vpqueue_reserve(&prqueue, capacity); }
+
+        bool shrink_to_fit() noexcept { return ::vpqueue_shrink_to_fit(&prqueue); }
+
+        bool push(const _TyValue& value) noexcept { return ::vpqueue_push_with(&prqueue, &value, sizeof(_TyValue), predicate); }
+
+        bool push_bulk(const _TyValue* const values, const unsigned long long count) noexcept {
+            return ::vpqueue_push_bulk_with(&prqueue, values, count, sizeof(_TyValue), predicate);
+        }
+
+        bool pop(_TyValue& value) noexcept { return ::vpqueue_pop_with(&prqueue, &value, sizeof(_TyValue), predicate); }
+
+        bool replace_top(const _TyValue& value, _TyValue& popped) noexcept {
+            return ::vpqueue_replace_top_with(&prqueue, &value, &popped, sizeof(_TyValue), predicate);
+        }
+
+        void pushpop(const _TyValue& value, _TyValue& popped) noexcept {
+            ::vpqueue_pushpop_with(&prqueue, &value, &popped, sizeof(_TyValue), predicate);
+        }
+
+        [[nodiscard]] const _TyValue* peek() const noexcept { return reinterpret_cast<const _TyValue*>(::vpqueue_peek(&prqueue)); }
+};